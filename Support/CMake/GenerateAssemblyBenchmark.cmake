@@ -0,0 +1,41 @@
+# Copyright (c) 2022 Tom Hancocks
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+# Generates a large number of independent StringList resources. This is used to measure how the assembly stage
+# scales with the number of jobs.
+
+if (NOT DEFINED COUNT)
+    set(COUNT 4096)
+endif()
+
+# Each resource is appended to the file as it is generated, as building the entire source in a single string is very
+# slow at this size.
+file(WRITE ${DST}.tmp "` Assembly benchmark: ${COUNT} StringList resources.\n@import Macintosh;\n\ndeclare StringList {\n")
+foreach(i RANGE 1 ${COUNT})
+    math(EXPR id "127 + ${i}")
+    set(RESOURCE_SOURCE "    new(#${id}, \"List ${i}\") {\n")
+    foreach(j RANGE 1 16)
+        string(APPEND RESOURCE_SOURCE "        String = \"String ${i}.${j}\";\n")
+    endforeach()
+    string(APPEND RESOURCE_SOURCE "    };\n")
+    file(APPEND ${DST}.tmp "${RESOURCE_SOURCE}")
+endforeach()
+file(APPEND ${DST}.tmp "};\n")
+file(RENAME ${DST}.tmp ${DST})
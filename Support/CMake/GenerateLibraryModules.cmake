@@ -0,0 +1,54 @@
+# Copyright (c) 2022 Tom Hancocks
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+# Embeds the type modules of the built-in libraries into a source file, so that they can be linked into the main
+# executable. LIBRARIES is a comma separated list of library names, each of which has a module in MODULE_DIR.
+
+string(REPLACE "," ";" LIBRARIES "${LIBRARIES}")
+
+set(MODULES_SOURCE "// Generated from the built-in library type modules. Do not edit.\n\n")
+string(APPEND MODULES_SOURCE "#include \"libraries/precompiled_libraries.hpp\"\n\nnamespace\n{\n")
+
+set(LOOKUP_SOURCE "")
+foreach(library ${LIBRARIES})
+    file(READ "${MODULE_DIR}/${library}.kdlm" module_hex HEX)
+    string(LENGTH "${module_hex}" module_hex_length)
+
+    # Write the bytes out 16 to a line.
+    string(APPEND MODULES_SOURCE "    const unsigned char s_${library}_module[] {\n")
+    foreach(offset RANGE 0 ${module_hex_length} 32)
+        string(SUBSTRING "${module_hex}" ${offset} 32 module_line)
+        if (NOT module_line STREQUAL "")
+            string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1, " module_line "${module_line}")
+            string(STRIP "${module_line}" module_line)
+            string(APPEND MODULES_SOURCE "        ${module_line}\n")
+        endif()
+    endforeach()
+    string(APPEND MODULES_SOURCE "    };\n")
+    string(APPEND LOOKUP_SOURCE "    if (name == \"${library}\") {\n")
+    string(APPEND LOOKUP_SOURCE "        return { reinterpret_cast<const char *>(s_${library}_module), sizeof(s_${library}_module) };\n")
+    string(APPEND LOOKUP_SOURCE "    }\n")
+endforeach()
+
+string(APPEND MODULES_SOURCE "}\n\n")
+string(APPEND MODULES_SOURCE "auto kdl::builtin::libraries::precompiled_module(const std::string& name) -> std::string_view\n{\n")
+string(APPEND MODULES_SOURCE "${LOOKUP_SOURCE}    return {};\n}\n")
+
+file(WRITE ${DST} "${MODULES_SOURCE}")
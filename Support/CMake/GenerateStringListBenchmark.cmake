@@ -0,0 +1,35 @@
+# Copyright (c) 2022 Tom Hancocks
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+# Generates a single StringList resource containing the maximum number of strings permitted by the type. This is
+# used to ensure that the cost of appending to a repeatable field does not grow with the size of the list.
+
+if (NOT DEFINED COUNT)
+    set(COUNT 32767)
+endif()
+
+set(BENCHMARK_SOURCE "` Regression benchmark: a StringList containing ${COUNT} strings.\n@import Macintosh;\n\n")
+string(APPEND BENCHMARK_SOURCE "declare StringList {\n    new(#128) {\n")
+foreach(i RANGE 1 ${COUNT})
+    string(APPEND BENCHMARK_SOURCE "        String = \"String ${i}\";\n")
+endforeach()
+string(APPEND BENCHMARK_SOURCE "    };\n};\n")
+
+file(WRITE ${DST} "${BENCHMARK_SOURCE}")
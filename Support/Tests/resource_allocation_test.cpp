@@ -0,0 +1,110 @@
+// Copyright (c) 2022 Tom Hancocks
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+#include "target/new/type_container.hpp"
+
+// This test ensures that the cost of instantiating a resource does not depend upon the size of the type template.
+// Every call to the global operator new is counted, and the allocations required to create a batch of instances of
+// a small type are compared against those required for a much larger type.
+
+static std::atomic<std::size_t> s_allocation_count { 0 };
+
+auto operator new(std::size_t size) -> void *
+{
+    ++s_allocation_count;
+    if (auto ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+auto operator delete(void *ptr) noexcept -> void
+{
+    std::free(ptr);
+}
+
+auto operator delete(void *ptr, std::size_t) noexcept -> void
+{
+    std::free(ptr);
+}
+
+// MARK: - Helpers
+
+static auto make_type(const std::string& code, std::size_t field_count) -> kdl::build_target::type_container
+{
+    kdl::build_target::type_template tmpl;
+    kdl::build_target::type_template::binary_field list(kdl::lexeme("Items", kdl::lexeme::identifier), kdl::build_target::OCNT);
+
+    for (std::size_t i = 0; i < field_count; ++i) {
+        auto label = kdl::lexeme(code + "Field" + std::to_string(i), kdl::lexeme::identifier);
+        tmpl.add_binary_field(kdl::build_target::type_template::binary_field(label, kdl::build_target::DWRD));
+        list.list_fields.emplace_back(kdl::build_target::type_template::binary_field(label, kdl::build_target::PSTR));
+    }
+    tmpl.add_binary_field(list);
+
+    kdl::build_target::type_container type(code, code);
+    type.set_internal_template(tmpl);
+    type.freeze();
+    return type;
+}
+
+static auto allocations_for_instances(const kdl::build_target::type_container& type, std::size_t count) -> std::size_t
+{
+    std::vector<kdl::build_target::resource_constructor> instances;
+    instances.reserve(count);
+
+    auto start = s_allocation_count.load();
+    for (std::size_t id = 0; id < count; ++id) {
+        instances.emplace_back(type.new_instance(nullptr, static_cast<std::int64_t>(id)));
+    }
+    return s_allocation_count.load() - start;
+}
+
+// MARK: - Test
+
+auto main() -> int
+{
+    constexpr std::size_t instance_count = 1000;
+
+    auto small_type = make_type("smal", 1);
+    auto large_type = make_type("larg", 64);
+
+    // Create an instance of each type first, so that any one time allocations are not counted.
+    (void)allocations_for_instances(small_type, 1);
+    (void)allocations_for_instances(large_type, 1);
+
+    auto small_allocations = allocations_for_instances(small_type, instance_count);
+    auto large_allocations = allocations_for_instances(large_type, instance_count);
+
+    std::cout << "Allocations for " << instance_count << " instances of a small type: " << small_allocations << std::endl;
+    std::cout << "Allocations for " << instance_count << " instances of a large type: " << large_allocations << std::endl;
+
+    if (large_allocations > small_allocations) {
+        std::cerr << "Instantiating a resource should not copy its type template." << std::endl;
+        return 1;
+    }
+    return 0;
+}
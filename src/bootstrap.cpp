@@ -0,0 +1,126 @@
+// Copyright (c) 2022 Tom Hancocks
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include "libraries/precompiled_libraries.hpp"
+#include "parser/file.hpp"
+#include "parser/lexer.hpp"
+#include "parser/parser.hpp"
+#include "target/target.hpp"
+#include "target/new/type_module.hpp"
+
+// The bootstrap assembler is a minimal build of KDL that compiles each of the built-in libraries from their source
+// into a type module. The modules are then embedded into the main executable.
+//
+//  kdl-bootstrap <library> <module path>
+//  kdl-bootstrap --benchmark <iterations> <module directory> <library>...
+
+// MARK: - Precompiled Libraries
+
+auto kdl::builtin::libraries::precompiled_module(const std::string&) -> std::string_view
+{
+    // The libraries have not been compiled yet, so they must always be imported from their source.
+    return {};
+}
+
+// MARK: - Library Import
+
+static auto import_library_source(const std::string& name) -> std::shared_ptr<kdl::target>
+{
+    auto target = std::make_shared<kdl::target>();
+    auto source = std::make_shared<kdl::file>(name + ".kdl", "@import " + name + ";\n");
+    kdl::sema::parser(target, kdl::lexer(source).analyze()).parse();
+    return target;
+}
+
+static auto import_library_module(const std::string& name, const std::string& module_data) -> std::shared_ptr<kdl::target>
+{
+    auto target = std::make_shared<kdl::target>();
+    auto file = std::make_shared<kdl::file>(name + kdl::build_target::type_module::extension, module_data);
+    auto module = kdl::build_target::type_module::read(file, kdl::lexeme(name, kdl::lexeme::identifier));
+    for (const auto& container : module.type_containers()) {
+        target->add_type_container(container);
+    }
+    return target;
+}
+
+// MARK: - Benchmark
+
+template<typename F>
+static auto measure(int iterations, F f) -> double
+{
+    auto start = std::chrono::steady_clock::now();
+    for (auto i = 0; i < iterations; ++i) {
+        f();
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+static auto benchmark(int iterations, const std::string& module_dir, const std::vector<std::string>& libraries) -> int
+{
+    for (const auto& name : libraries) {
+        std::ifstream in(module_dir + "/" + name + kdl::build_target::type_module::extension, std::ios::binary);
+        if (!in.is_open()) {
+            std::cerr << "Missing type module for library: " << name << std::endl;
+            return 1;
+        }
+        std::ostringstream module_data;
+        module_data << in.rdbuf();
+
+        auto source_time = measure(iterations, [&] { import_library_source(name); });
+        auto module_time = measure(iterations, [&] { import_library_module(name, module_data.str()); });
+
+        std::cout << name << ": source " << source_time << "ms, precompiled " << module_time << "ms per import ("
+                  << (source_time / module_time) << "x)" << std::endl;
+    }
+    return 0;
+}
+
+// MARK: - Entry Point
+
+auto main(int argc, const char **argv) -> int
+{
+    if (argc >= 5 && std::string(argv[1]) == "--benchmark") {
+        return benchmark(std::max(std::atoi(argv[2]), 1), argv[3], std::vector<std::string>(argv + 4, argv + argc));
+    }
+    else if (argc != 3) {
+        std::cerr << "Usage: kdl-bootstrap <library> <module path>" << std::endl;
+        return 1;
+    }
+
+    // Import the library from its source, and then write every type that it defined to the module.
+    auto target = import_library_source(argv[1]);
+
+    kdl::build_target::type_module module;
+    for (std::size_t i = 0; i < target->type_container_count(); ++i) {
+        module.add_type_container(target->type_container_at(static_cast<int>(i)));
+    }
+    module.write(argv[2]);
+
+    return 0;
+}
@@ -26,7 +26,7 @@
 
 // MARK: - Construction
 
-kdl::codegen::lua::type_exporter::type_exporter(kdl::build_target::type_container &container)
+kdl::codegen::lua::type_exporter::type_exporter(const kdl::build_target::type_container &container)
     : m_container(container)
 {
     load_kestrel_api();
@@ -166,7 +166,7 @@ auto kdl::codegen::lua::type_exporter::build_field_name(build_target::type_field
 
 auto kdl::codegen::lua::type_exporter::field_for_binary_field(const build_target::type_template::binary_field &field) -> build_target::type_field
 {
-    auto tmpl = m_container.internal_template();
+    const auto& tmpl = m_container.internal_template();
 
     for (const auto& container_field : m_container.all_fields()) {
 
@@ -206,7 +206,7 @@ auto kdl::codegen::lua::type_exporter::field_for_binary_field(const build_target
 
 auto kdl::codegen::lua::type_exporter::field_value_for_binary_field(const build_target::type_template::binary_field &field) -> build_target::type_field_value
 {
-    auto tmpl = m_container.internal_template();
+    const auto& tmpl = m_container.internal_template();
 
     for (const auto& container_field : m_container.all_fields()) {
 
@@ -242,7 +242,7 @@ auto kdl::codegen::lua::type_exporter::field_value_for_binary_field(const build_
 
 auto kdl::codegen::lua::type_exporter::prepare_template_read_calls(ast::symbol *resource, ast::symbol *data) -> void
 {
-   auto tmpl = m_container.internal_template();
+   const auto& tmpl = m_container.internal_template();
 
    // The first task for the resource reader is to produce all the read calls for the binary template fields.
    for (const auto& field : m_container.all_fields()) {
@@ -304,7 +304,7 @@ auto kdl::codegen::lua::type_exporter::prepare_template_read_calls(ast::symbol *
 
 auto kdl::codegen::lua::type_exporter::produce_template_read_calls(ast::symbol *resource) -> void
 {
-    auto tmpl = m_container.internal_template();
+    const auto& tmpl = m_container.internal_template();
     for (auto i = 0; i < tmpl.binary_field_count(); ++i) {
         auto bin_field = tmpl.binary_field_at(i);
         auto it = m_type.bin_fields.find(bin_field.label.text());
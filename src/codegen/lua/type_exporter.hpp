@@ -30,12 +30,12 @@ namespace kdl::codegen::lua
     class type_exporter
     {
     public:
-        explicit type_exporter(kdl::build_target::type_container& container);
+        explicit type_exporter(const kdl::build_target::type_container& container);
 
         [[nodiscard]] auto generate_lua() -> std::string;
 
     private:
-        kdl::build_target::type_container& m_container;
+        const kdl::build_target::type_container& m_container;
         ast::generator m_gen;
 
         struct {
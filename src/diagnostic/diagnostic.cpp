@@ -21,8 +21,36 @@
 #include <iostream>
 #include "diagnostic/fatal.hpp"
 
+static thread_local bool s_defer_errors = false;
+
+// MARK: - Reporting
+
 auto kdl::log::fatal_error(const kdl::lexeme& lx, int code, const std::string& message) -> void
 {
+    // Exiting runs static destructors, which is only safe once no other threads are running. Worker threads throw
+    // their errors back to the thread that started them instead.
+    if (s_defer_errors) {
+        throw fatal_diagnostic { lx, code, message };
+    }
+
     std::cerr << lx.location() << " - " << message << std::endl;
     exit(code);
 }
+
+auto kdl::log::fatal_error(const fatal_diagnostic& diagnostic) -> void
+{
+    fatal_error(diagnostic.lexeme, diagnostic.code, diagnostic.message);
+}
+
+// MARK: - Deferred Errors
+
+kdl::log::deferred_errors::deferred_errors()
+    : m_previous(s_defer_errors)
+{
+    s_defer_errors = true;
+}
+
+kdl::log::deferred_errors::~deferred_errors()
+{
+    s_defer_errors = m_previous;
+}
@@ -34,4 +34,37 @@ namespace kdl::log
      */
     [[noreturn]] auto fatal_error(const kdl::lexeme& lx, int code, const std::string& message) -> void;
 
+    /**
+     * A fatal error that was raised on a thread that defers its errors.
+     */
+    struct fatal_diagnostic
+    {
+        kdl::lexeme lexeme;
+        int code;
+        std::string message;
+    };
+
+    /**
+     * Reports a fatal error that was previously deferred, and terminates.
+     */
+    [[noreturn]] auto fatal_error(const fatal_diagnostic& diagnostic) -> void;
+
+    /**
+     * Whilst an instance of this is alive, fatal errors raised on the current thread are thrown as a fatal_diagnostic
+     * rather than terminating the process. Worker threads use this to hand their errors back to the thread that
+     * started them, which reports them once every worker has finished.
+     */
+    class deferred_errors
+    {
+    public:
+        deferred_errors();
+        ~deferred_errors();
+
+        deferred_errors(const deferred_errors&) = delete;
+        auto operator=(const deferred_errors&) -> deferred_errors& = delete;
+
+    private:
+        bool m_previous;
+    };
+
 }
@@ -23,7 +23,7 @@
 
 // MARK: - Construction
 
-kdl::disassembler::binary_parser::binary_parser(kdl::build_target::type_template &tmpl)
+kdl::disassembler::binary_parser::binary_parser(const kdl::build_target::type_template &tmpl)
     : m_tmpl(tmpl)
 {
 }
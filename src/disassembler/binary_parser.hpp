@@ -31,12 +31,12 @@ namespace kdl::disassembler
     class binary_parser
     {
     public:
-        binary_parser(build_target::type_template& tmpl);
+        binary_parser(const build_target::type_template& tmpl);
 
         auto parse(graphite::data::reader& reader) -> std::map<int, std::any>;
 
     private:
-        build_target::type_template& m_tmpl;
+        const build_target::type_template& m_tmpl;
         int m_index { 0 };
 
         auto extract_value(graphite::data::reader& reader) -> std::any;
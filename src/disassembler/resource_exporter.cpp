@@ -30,7 +30,7 @@
 // MARK: - Construction
 
 kdl::disassembler::resource_exporter::resource_exporter(task& task, kdl::disassembler::kdl_exporter &exporter,
-                                                        build_target::type_container& type)
+                                                        const build_target::type_container& type)
     : m_exporter(exporter),
       m_container(type),
       m_task(task),
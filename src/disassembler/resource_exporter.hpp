@@ -35,7 +35,7 @@ namespace kdl::disassembler
     class resource_exporter
     {
     public:
-        resource_exporter(task& task, kdl_exporter& exporter, build_target::type_container& type);
+        resource_exporter(task& task, kdl_exporter& exporter, const build_target::type_container& type);
 
         auto disassemble(graphite::rsrc::resource *resource) -> void;
 
@@ -43,7 +43,7 @@ namespace kdl::disassembler
         graphite::rsrc::resource::identifier m_id;
         task& m_task;
         kdl_exporter& m_exporter;
-        build_target::type_container& m_container;
+        const build_target::type_container& m_container;
         std::map<int, std::any> m_extracted_values;
         std::map<int, int> m_visited_template_fields;
         std::map<int, std::tuple<graphite::data::block, std::string>> m_file_exports;
@@ -133,7 +133,7 @@ auto kdl::disassembler::task::disassemble_resources() -> void
         kdl::file::create_directory(file_dir);
         // Iterate through all types registered in KDL, and check if the type exists in the resource file.
         for (auto i = 0; i < m_target->type_container_count(); ++i) {
-            auto type_container = m_target->type_container_at(i);
+            const auto& type_container = m_target->type_container_at(i);
 
             if (auto type = const_cast<graphite::rsrc::type *>(file->type(type_container.code()))) {
                 if (type->count() == 0) {
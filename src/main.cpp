@@ -18,12 +18,24 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <algorithm>
+#include <cstdlib>
+#include <atomic>
 #include <iostream>
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <thread>
 #include "kdl_version.hpp"
 #include "parser/file.hpp"
 #include "parser/lexer.hpp"
+#include "diagnostic/fatal.hpp"
 #include "parser/parser.hpp"
 #include "target/target.hpp"
+#include "target/new/type_module.hpp"
+#include "target/new/object_file.hpp"
+#include "target/new/assembly_cache.hpp"
 #include "analyzer/template_extractor.hpp"
 #include "installer/installer_asset.hpp"
 #include "libGraphite/rsrc/manager.hpp"
@@ -32,6 +44,17 @@ auto main(int argc, const char **argv) -> int
 {
     auto target = std::make_shared<kdl::target>();
     std::vector<std::shared_ptr<kdl::file>> files;
+    std::vector<std::shared_ptr<kdl::file>> type_files;
+    auto report_timings = false;
+    auto emit_ir = false;
+    auto compile_object = false;
+    auto link_objects = false;
+    std::optional<std::string> output_path;
+    std::optional<std::string> module_path;
+    std::optional<std::string> cache_path;
+    auto cache_size_limit = kdl::build_target::assembly_cache::default_size_limit;
+    std::size_t jobs = 1;
+    std::size_t parse_jobs = 1;
 
     // Load in the default system configuration.
     // TODO: The configuration file should be located in a different location on Windows.
@@ -74,6 +97,7 @@ auto main(int argc, const char **argv) -> int
                 // or a directory. If it is a file then extract the file name. It needs to be separated
                 // from the output directory.
                 target->set_dst_path(argv[i + 1]);
+                output_path = std::string(argv[i + 1]);
 
                 // Make we skip over the parameter.
                 i += 1;
@@ -123,6 +147,66 @@ auto main(int argc, const char **argv) -> int
                 target->set_format(argv[i + 1]);
                 i += 1;
             }
+            else if (arg == "--timings") {
+                // Report how long each of the build phases took once the build has completed.
+                report_timings = true;
+            }
+            else if ((arg == "-j" || arg == "--jobs") && i + 1 < argc) {
+                // Set the number of threads that resources are assembled on. The output is the same regardless of the
+                // number of jobs.
+                jobs = static_cast<std::size_t>(std::max(std::atoi(argv[i + 1]), 1));
+                target->set_assembly_jobs(jobs);
+                i += 1;
+            }
+            else if (arg == "--parse-jobs" && i + 1 < argc) {
+                // Set the number of threads that input files are parsed on. Each file is parsed on its own copy of
+                // the target, and the results are merged in the order that the files were given.
+                parse_jobs = static_cast<std::size_t>(std::max(std::atoi(argv[i + 1]), 1));
+                i += 1;
+            }
+            else if (arg == "--types" && i + 1 < argc) {
+                // Specify a file of type definitions and constants that the input files depend upon. These are
+                // always parsed before any of the input files, and before they are split between parse jobs.
+                type_files.emplace_back(std::make_shared<kdl::file>(argv[i + 1]));
+                i += 1;
+            }
+            else if (arg == "--emit-ir") {
+                // Print the resources that have been declared, as their resolved field values, before they are
+                // assembled into binary data.
+                emit_ir = true;
+            }
+            else if (arg == "--cache" && i + 1 < argc) {
+                // Keep the assembled data of expensive resources in the specified directory, such as .kdl-cache,
+                // so that later builds can reuse it for any resource that has not changed.
+                cache_path = std::string(argv[i + 1]);
+                i += 1;
+            }
+            else if (arg == "--cache-size" && i + 1 < argc) {
+                // Limit the size of the cache, in megabytes. The least recently used entries are removed first.
+                cache_size_limit = static_cast<std::uint64_t>(std::max(std::atoll(argv[i + 1]), 1LL)) * 1024 * 1024;
+                i += 1;
+            }
+            else if (arg == "--emit-module" && i + 1 < argc) {
+                // Write every type that has been defined to a precompiled type module, which can then be imported
+                // by other projects without parsing the type definitions again.
+                module_path = std::string(argv[i + 1]);
+                i += 1;
+            }
+            else if (arg == "-c" || arg == "--compile") {
+                // Compile the input files into an object file, rather than a resource file. Object files are
+                // combined into a resource file with --link, so that each source only needs to be compiled again
+                // when it changes.
+                compile_object = true;
+            }
+            else if (arg == "--link") {
+                // Treat each of the input files as an object file, and link them into a single resource file.
+                link_objects = true;
+            }
+            else if (arg == "--verify-expressions") {
+                // Evaluate every compiled expression a second time with the reference evaluator, and fail the
+                // build if the two disagree.
+                target->set_verify_expressions(true);
+            }
         }
 
         // Anything else should be treated as an input file.
@@ -131,31 +215,174 @@ auto main(int argc, const char **argv) -> int
         }
     }
 
-    if (!files.empty()) {
-        // Loop through each of the files and parse them.
+    // Lexical analysis is interleaved with parsing, so the two are timed together.
+    std::size_t parsed_bytes = 0;
+    auto parse_start = std::chrono::steady_clock::now();
+
+    if (link_objects) {
+        // Objects already contain everything that was defined and declared by their sources, so there is nothing to
+        // parse. They only need to be combined, and their resources given their final ids.
+        std::vector<kdl::build_target::object_file> objects;
+        objects.reserve(files.size());
         for (const auto& file : files) {
-            // 0. Configure the target.
-            target->set_src_root(file->path());
+            objects.emplace_back(kdl::build_target::object_file::read(file, kdl::lexeme(file->path(), kdl::lexeme::string)));
+        }
+        kdl::build_target::object_file::link(objects, target);
+    }
+    else {
+        // Each file is streamed through the parser, so that only the lexemes being looked at are held in memory.
+        auto parse_file = [&] (const std::shared_ptr<kdl::target>& file_target, const std::shared_ptr<kdl::file>& file) {
+            file_target->set_src_root(file->path());
+            file_target->track_imported_file(file);
+            kdl::sema::parser(file_target, std::make_shared<kdl::lexer>(file)).parse();
+        };
+
+        for (const auto& file : type_files) {
+            parsed_bytes += file->view().size();
+            parse_file(target, file);
+        }
 
-            // 1. Perform lexical analysis.
-            kdl::lexer lexer(file);
-            auto lexemes = lexer.analyze();
+        for (const auto& file : files) {
+            parsed_bytes += file->view().size();
+        }
 
-            // 2. Parse the lexical analysis result.
-            kdl::sema::parser parser(target, lexemes);
-            parser.parse();
+        auto workers_count = std::min(parse_jobs, files.size());
+        if (compile_object || workers_count <= 1) {
+            // Loop through each of the files and parse them.
+            for (const auto& file : files) {
+                parse_file(target, file);
+            }
         }
+        else {
+            // Each file is parsed into its own fork of the target, and then compiled into an object, exactly as if
+            // it had been built on its own with --compile. The objects are then linked in the order that the files
+            // were given, so that automatic resource ids are allocated in the same order as a serial build. Output
+            // from the files is held until then, so that it appears in the same order too.
+            std::vector<std::optional<kdl::build_target::object_file>> objects(files.size());
+            std::vector<std::ostringstream> outputs(files.size());
+            std::atomic<std::size_t> next { 0 };
+            std::mutex error_lock;
+            std::optional<kdl::log::fatal_diagnostic> error;
+            auto error_index = files.size();
+
+            std::vector<std::thread> workers;
+            workers.reserve(workers_count);
+            for (std::size_t n = 0; n < workers_count; ++n) {
+                workers.emplace_back([&] {
+                    kdl::log::deferred_errors deferred;
+                    for (auto i = next++; i < files.size(); i = next++) {
+                        try {
+                            auto file_target = target->fork();
+                            file_target->set_output(outputs[i]);
+                            parse_file(file_target, files[i]);
+                            objects[i] = kdl::build_target::object_file::compile(file_target, target.get());
+                        }
+                        catch (const kdl::log::fatal_diagnostic& diagnostic) {
+                            // Keep the error from the earliest file, so that the same error is reported as in a
+                            // serial build, and stop any files that have not been started.
+                            std::lock_guard<std::mutex> lock(error_lock);
+                            if (i < error_index) {
+                                error_index = i;
+                                error = diagnostic;
+                            }
+                            next = files.size();
+                        }
+                    }
+                });
+            }
+
+            for (auto& worker : workers) {
+                worker.join();
+            }
+
+            std::vector<kdl::build_target::object_file> linked_objects;
+            linked_objects.reserve(files.size());
+            for (std::size_t i = 0; i < files.size(); ++i) {
+                target->output() << outputs[i].str();
+                if (i == error_index) {
+                    kdl::log::fatal_error(error.value());
+                }
+                linked_objects.emplace_back(std::move(objects[i].value()));
+            }
+            kdl::build_target::object_file::link(linked_objects, target);
+        }
+    }
+
+    std::chrono::duration<double> parse_time = std::chrono::steady_clock::now() - parse_start;
+
+    // Write out the type module, if requested. This only needs the type definitions, so does not wait for assembly.
+    if (module_path.has_value()) {
+        kdl::build_target::type_module module;
+        for (std::size_t i = 0; i < target->type_container_count(); ++i) {
+            module.add_type_container(target->type_container_at(static_cast<int>(i)));
+        }
+        module.write(module_path.value());
+    }
+
+    // Show the intermediate representation of the resources, if requested, and then assemble them.
+    if (emit_ir) {
+        target->write_ir(std::cout);
+    }
+
+    if (cache_path.has_value()) {
+        target->set_assembly_cache(std::make_shared<kdl::build_target::assembly_cache>(
+            kdl::file::resolve_tilde(cache_path.value()), cache_size_limit
+        ));
     }
 
-    // Finally save the target to disk, if there are resources present in it.
-    if (target->type_container_count() > 0) {
+    // When compiling an object, the resources are assembled into the object rather than into the target.
+    std::optional<kdl::build_target::object_file> object;
+    auto assembly_start = std::chrono::steady_clock::now();
+    if (compile_object) {
+        object = kdl::build_target::object_file::compile(target);
+    }
+    else {
+        target->assemble_resources();
+    }
+    std::chrono::duration<double> assembly_time = std::chrono::steady_clock::now() - assembly_start;
+
+    // Finally save the object or the target to disk, if there are resources present in it.
+    if (object.has_value()) {
+        auto object_path = output_path.value_or("result");
+        if (!kdl::build_target::object_file::is_object_path(object_path)) {
+            object_path += kdl::build_target::object_file::extension;
+        }
+        object->write(object_path);
+    }
+    else if (target->type_container_count() > 0) {
         target->save();
     }
 
+    // Keep the cache within its size limit, now that this build has finished using it.
+    if (auto cache = target->assembly_cache()) {
+        cache->evict();
+    }
+
     // Perform disassembly if a disassembly option has been specified.
     if (target->disassembler().has_value()) {;
         target->disassembler()->disassemble_resources();
     }
 
+    if (report_timings && parsed_bytes > 0) {
+        auto megabytes = static_cast<double>(parsed_bytes) / (1024.0 * 1024.0);
+        std::cout << "Lexing and parsing: " << parsed_bytes << " bytes in " << parse_time.count() << "s ("
+                  << (megabytes / parse_time.count()) << " MB/s, " << parse_jobs << " jobs)" << std::endl;
+    }
+
+    if (report_timings) {
+        std::cout << "Assembly: " << target->resources().size() << " resources in "
+                  << assembly_time.count() << "s (" << target->assembly_jobs() << " jobs)" << std::endl;
+
+        if (auto cache = target->assembly_cache()) {
+            auto cache_stats = cache->statistics();
+            std::cout << "Assembly cache: " << cache_stats.hits << " hits, " << cache_stats.misses << " misses, "
+                      << cache_stats.evictions << " evicted" << std::endl;
+        }
+
+        const auto& stats = target->expression_statistics();
+        std::cout << "Expression cache: " << stats.hits << " hits, " << stats.misses << " misses, "
+                  << stats.folded << " functions folded" << std::endl;
+    }
+
     return 0;
 }
\ No newline at end of file
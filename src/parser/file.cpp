@@ -19,9 +19,12 @@
 #else
     // Linux / macOS Specific
 #   define USE_GLOB
+#   define USE_MMAP
 #   include <glob.h>
 #   include <pwd.h>
 #   include <unistd.h>
+#   include <fcntl.h>
+#   include <sys/mman.h>
 #endif
 
 // MARK: - Prototypes
@@ -199,25 +202,29 @@ kdl::file::file()
 kdl::file::file(std::string_view path)
     : m_path(resolve_tilde(path))
 {
-    if (exists(m_path)) {
-        std::ifstream f(m_path, std::ios::binary);
+    struct stat info {};
+    if (stat(m_path.c_str(), &info) != 0) {
+        return;
+    }
 
-        // Reserve space in the m_contents string, equivalent to the length of the file.
-        f.seekg(0, std::ios::end);
-        m_length = static_cast<uint64_t>(f.tellg());
-        m_raw = new uint8_t[m_length + 1];
-        memset(m_raw, 0, m_length);
-        f.seekg(0, std::ios::beg);
+    if (map(static_cast<std::size_t>(info.st_size))) {
+        return;
+    }
 
-        // Read in the contents of the file.
-        f.read((char *)m_raw, m_length);
-        m_raw[m_length++] = '\n';
+    std::ifstream f(m_path, std::ios::binary);
 
-        f.close();
-    }
-    else {
-        m_raw = nullptr;
-    }
+    // Reserve space in the m_contents string, equivalent to the length of the file.
+    f.seekg(0, std::ios::end);
+    m_length = static_cast<uint64_t>(f.tellg());
+    m_raw = new uint8_t[m_length + 1];
+    memset(m_raw, 0, m_length);
+    f.seekg(0, std::ios::beg);
+
+    // Read in the contents of the file.
+    f.read((char *)m_raw, m_length);
+    m_raw[m_length++] = '\n';
+
+    f.close();
 }
 
 kdl::file::file(const std::string &name, const std::string &contents)
@@ -233,7 +240,57 @@ kdl::file::file(const std::string &name, const std::string &contents)
 
 kdl::file::~file()
 {
+    release();
+}
+
+// MARK: - Memory Mapping
+
+auto kdl::file::map(std::size_t size) -> bool
+{
+#if defined(USE_MMAP)
+    // Files read from disk are always terminated with a newline, which the lexer depends upon. The mapping is private
+    // and writable so that the newline can be placed in the unused tail of the final page. If the file exactly fills
+    // its final page then there is no room for it, and the file is read onto the heap instead.
+    auto page_size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    if (size == 0 || (size % page_size) == 0) {
+        return false;
+    }
+
+    auto fd = open(m_path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    auto ptr = mmap(nullptr, size + 1, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (ptr == MAP_FAILED) {
+        return false;
+    }
+
+    m_raw = static_cast<uint8_t *>(ptr);
+    m_raw[size] = '\n';
+    m_length = size + 1;
+    m_mapped_length = m_length;
+    return true;
+#else
+    return false;
+#endif
+}
+
+auto kdl::file::release() -> void
+{
+#if defined(USE_MMAP)
+    if (m_mapped_length > 0) {
+        munmap(m_raw, m_mapped_length);
+        m_raw = nullptr;
+        m_mapped_length = 0;
+        return;
+    }
+#endif
+
     delete[] m_raw;
+    m_raw = nullptr;
 }
 
 // MARK: - Accessors
@@ -261,11 +318,19 @@ auto kdl::file::vector() -> std::vector<char>
     return v;
 }
 
+auto kdl::file::view() const -> std::string_view
+{
+    return { reinterpret_cast<const char *>(m_raw), m_length };
+}
+
+auto kdl::file::bytes() const -> std::span<const std::uint8_t>
+{
+    return { m_raw, m_length };
+}
+
 auto kdl::file::set_contents(const std::string& contents) -> void
 {
-    if (m_raw) {
-        delete[] m_raw;
-    }
+    release();
 
     m_length = contents.size();
     m_raw = new uint8_t[m_length];
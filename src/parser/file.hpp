@@ -4,7 +4,10 @@
 
 #pragma once
 
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include <span>
 #include <vector>
 #include <memory>
 #include <optional>
@@ -35,8 +38,12 @@ namespace kdl
 
         ~file();
 
+        file(const file&) = delete;
+        auto operator=(const file&) -> file& = delete;
+
         /**
-         * Read the specified file from disk.
+         * Read the specified file from disk. Where the platform allows, the file will be memory mapped
+         * rather than read into a heap allocated buffer.
          * @param path The path from with the load the file.
          */
         explicit file(std::string_view path);
@@ -59,6 +66,18 @@ namespace kdl
          */
         auto contents() -> std::string;
 
+        /**
+         * A view of the contents of the file. The view is only valid for as long as the file exists
+         * and its contents are not changed.
+         */
+        [[nodiscard]] auto view() const -> std::string_view;
+
+        /**
+         * A view of the raw bytes of the file. The view is only valid for as long as the file exists
+         * and its contents are not changed.
+         */
+        [[nodiscard]] auto bytes() const -> std::span<const std::uint8_t>;
+
         /**
          * Set the contents of the file without saving the changes to disk.
          * @param contents The new contents of the file.
@@ -77,8 +96,12 @@ namespace kdl
 
     private:
         std::string m_path;
-        uint8_t *m_raw;
-        uint64_t m_length;
+        uint8_t *m_raw { nullptr };
+        uint64_t m_length { 0 };
+        uint64_t m_mapped_length { 0 };
+
+        auto map(std::size_t size) -> bool;
+        auto release() -> void;
 
     };
 
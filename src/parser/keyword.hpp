@@ -0,0 +1,54 @@
+// Copyright (c) 2022 Tom Hancocks
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <array>
+#include <string_view>
+#include "parser/symbol_table.hpp"
+
+namespace kdl::keyword
+{
+
+    /**
+     * The keywords that the parser looks for are interned into the symbol table before any other text, in the
+     * order that they are listed here. This means that the symbol of each keyword is known at compile time, and
+     * can be compared against a lexeme without looking at its text.
+     */
+    constexpr std::array<std::string_view, 11> names {
+        "", "type", "example", "declare", "component", "lua_export", "new", "override", "duplicate", "as", "hint"
+    };
+
+    constexpr symbol_table::symbol none = 0;
+    constexpr symbol_table::symbol type = 1;
+    constexpr symbol_table::symbol example = 2;
+    constexpr symbol_table::symbol declare = 3;
+    constexpr symbol_table::symbol component = 4;
+    constexpr symbol_table::symbol lua_export = 5;
+    constexpr symbol_table::symbol new_ = 6;
+    constexpr symbol_table::symbol override_ = 7;
+    constexpr symbol_table::symbol duplicate = 8;
+    constexpr symbol_table::symbol as = 9;
+    constexpr symbol_table::symbol hint = 10;
+
+    static_assert(hint + 1 == names.size(), "Every keyword constant must have a name, in the same order.");
+
+}
@@ -0,0 +1,116 @@
+// Copyright (c) 2019-2020 Tom Hancocks
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "parser/lexeme.hpp"
+
+// MARK: - Source Registry
+
+namespace
+{
+    std::mutex s_source_lock;
+    std::vector<std::weak_ptr<kdl::file>> s_sources { {} };
+    std::vector<std::string_view> s_source_texts { {} };
+    std::vector<std::shared_ptr<kdl::file>> s_retained_sources;
+    std::unordered_map<const kdl::file *, kdl::lexeme::source_id> s_source_ids;
+}
+
+auto kdl::lexeme::register_source(const std::weak_ptr<file>& owner) -> source_id
+{
+    auto file = owner.lock();
+    if (!file) {
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(s_source_lock);
+
+    // The address of a file might be reused once the original file has been released, so make sure that any
+    // existing registration is still for the same file before returning it.
+    auto it = s_source_ids.find(file.get());
+    if (it != s_source_ids.end() && s_sources[it->second].lock() == file) {
+        return it->second;
+    }
+
+    auto id = static_cast<source_id>(s_sources.size());
+    s_sources.emplace_back(file);
+    s_source_texts.emplace_back();
+    s_source_ids[file.get()] = id;
+    return id;
+}
+
+auto kdl::lexeme::retain_source(const std::shared_ptr<file>& owner) -> source_id
+{
+    auto id = register_source(owner);
+    if (id == 0) {
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(s_source_lock);
+    if (s_source_texts[id].data() == nullptr) {
+        s_source_texts[id] = owner->view();
+        s_retained_sources.emplace_back(owner);
+    }
+    return id;
+}
+
+auto kdl::lexeme::source_text(source_id source) -> std::string_view
+{
+    std::lock_guard<std::mutex> lock(s_source_lock);
+    return s_source_texts[source];
+}
+
+auto kdl::lexeme::owner() const -> std::shared_ptr<file>
+{
+    if (m_source == 0) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(s_source_lock);
+    return s_sources[m_source].lock();
+}
+
+// MARK: - Diagnostics
+
+auto kdl::lexeme::source_directory() const -> std::string
+{
+    if (auto file = owner()) {
+        auto file_path = file->path();
+        auto parent_directory_path = file_path.substr(0, file_path.find_last_of('/'));
+        return parent_directory_path;
+    }
+    return "";
+}
+
+auto kdl::lexeme::location() const -> std::string
+{
+    std::string result;
+
+    // Only attach the file if we still have a valid reference to it. If the file has been
+    // released then omit it.
+    if (auto file = owner()) {
+        result += file->path() + ":";
+    }
+
+    // Encode the line and offset, and return the result.
+    result += "L" + std::to_string(m_line) + ":" + std::to_string(m_offset);
+    return result;
+}
@@ -20,11 +20,14 @@
 
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <type_traits>
 #include <utility>
+#include <vector>
 #include "parser/file.hpp"
+#include "parser/symbol_table.hpp"
 
 namespace kdl
 {
@@ -34,10 +37,20 @@ namespace kdl
      * The kdl::lexeme structure represents a single token/lexeme within a KDL source file. It has
      * the source text value, the position of it within the file, and the owning file from which it
      * came.
+     *
+     * Lexemes are copied by value throughout the parser, and so are kept deliberately small. The text
+     * of the lexeme is held in the kdl::symbol_table and the owning file is referenced by a source id.
+     * Both are resolved lazily, when they are actually required.
+     *
+     * Literals are the exception, as there is no bound on how many different literals a source may
+     * contain. Their text is a view of the source file instead, so nothing is kept for a literal once
+     * its lexeme has been dropped.
      */
     struct lexeme
     {
     public:
+        typedef std::uint32_t source_id;
+
         enum type
         {
             any,
@@ -55,7 +68,7 @@ namespace kdl
          * @param type The lexical type that the token is
          */
         lexeme(const std::string& text, enum type type)
-            : m_text(std::move(text)), m_type(type), m_owner({}), m_pos(0), m_offset(0), m_line(0)
+            : m_symbol(symbol_table::shared().intern(text)), m_type(type)
         {
 
         }
@@ -70,34 +83,92 @@ namespace kdl
          * @param owner The file from which the token originated.
          */
         lexeme(const std::string& text, enum type type, std::size_t pos, std::size_t offset, std::size_t line, std::weak_ptr<file> owner)
-            : m_text(std::move(text)), m_type(type), m_pos(pos), m_offset(offset), m_line(line), m_owner(owner)
+            : lexeme(text, type, pos, offset, line, register_source(owner))
         {
 
         }
 
         lexeme(const std::vector<std::string>& components, enum type type, std::size_t pos, std::size_t offset, std::size_t line, std::weak_ptr<file> owner)
-            : m_components(components), m_type(type), m_pos(pos), m_offset(offset), m_line(line), m_owner(owner)
+            : lexeme(components, type, pos, offset, line, register_source(owner))
         {
-            auto is_first = true;
-            for (const auto& component : m_components) {
-                m_text += (is_first ? "" : ".") + component;
-                is_first = false;
-            }
+
         }
 
         /**
-         * Returns the path to the directory, that contains the file from which the lexeme was extracted.
+         * Constructs a new lexeme, from a source that has already been registered.
+         * @param text The source text value from which this lexeme is being created.
+         * @param type The lexical type that the token is
+         * @param pos The absolute position of the token within the source file.
+         * @param offset The position of the token upon the current line.
+         * @param line The line that the token was found.
+         * @param source The registered source from which the token originated.
          */
-        [[nodiscard]] auto source_directory() const -> std::string
+        lexeme(std::string_view text, enum type type, std::size_t pos, std::size_t offset, std::size_t line, source_id source)
+            : m_symbol(symbol_table::shared().intern(text)),
+              m_source(source),
+              m_pos(static_cast<std::uint32_t>(pos)),
+              m_offset(static_cast<std::uint32_t>(offset)),
+              m_line(static_cast<std::uint32_t>(line)),
+              m_type(type)
         {
-            if (auto file = m_owner.lock()) {
-                auto file_path = file->path();
-                auto parent_directory_path = file_path.substr(0, file_path.find_last_of('/'));
-                return parent_directory_path;
-            }
-            return "";
+
+        }
+
+        lexeme(const std::vector<std::string>& components, enum type type, std::size_t pos, std::size_t offset, std::size_t line, source_id source)
+            : m_symbol(symbol_table::shared().intern(components)),
+              m_source(source),
+              m_pos(static_cast<std::uint32_t>(pos)),
+              m_offset(static_cast<std::uint32_t>(offset)),
+              m_line(static_cast<std::uint32_t>(line)),
+              m_type(type),
+              m_flags(has_components)
+        {
+
         }
 
+        /**
+         * Constructs a new literal lexeme, that refers to its text within the source rather than interning it.
+         * @param type The lexical type that the token is
+         * @param start The absolute position of the text within the source file.
+         * @param length The length of the text.
+         * @param offset The position of the token upon the current line.
+         * @param line The line that the token was found.
+         * @param source The source from which the token originated, which must have been retained.
+         */
+        static auto literal(enum type type, std::size_t start, std::size_t length, std::size_t offset, std::size_t line, source_id source) -> lexeme
+        {
+            lexeme lx(type, static_cast<std::uint32_t>(start), static_cast<std::uint32_t>(offset), static_cast<std::uint32_t>(line), source);
+            lx.m_symbol = static_cast<std::uint32_t>(length);
+            lx.m_flags = is_view;
+            return lx;
+        }
+
+        /**
+         * Register a source file so that lexemes may refer to it by id. Registering the same file multiple
+         * times will return the same id. The registry does not keep the file alive.
+         * @param owner The file to register.
+         * @return An id for the file. An id of 0 indicates that there is no file.
+         */
+        static auto register_source(const std::weak_ptr<file>& owner) -> source_id;
+
+        /**
+         * Register a source file, and keep it alive for the rest of the build, so that literal lexemes may refer to
+         * its text.
+         * @param owner The file to register.
+         * @return An id for the file.
+         */
+        static auto retain_source(const std::shared_ptr<file>& owner) -> source_id;
+
+        /**
+         * Returns the file from which the lexeme was extracted, if it is still available.
+         */
+        [[nodiscard]] auto owner() const -> std::shared_ptr<file>;
+
+        /**
+         * Returns the path to the directory, that contains the file from which the lexeme was extracted.
+         */
+        [[nodiscard]] auto source_directory() const -> std::string;
+
         /**
          * Returns a string describing the location of the lexeme, for example:
          *
@@ -105,24 +176,14 @@ namespace kdl
          *
          * @return A string representing the location of the lexeme.
          */
-        [[nodiscard]] auto location() const -> std::string
-        {
-            std::string result;
-
-            // Only attach the file if we still have a valid reference to it. If the file has been
-            // released then omit it.
-            if (auto file = m_owner.lock()) {
-                result += file->path() + ":";
-            }
-
-            // Encode the line and offset, and return the result.
-            result += "L" + std::to_string(m_line) + ":" + std::to_string(m_offset);
-            return result;
-        }
+        [[nodiscard]] auto location() const -> std::string;
 
         [[nodiscard]] auto is(const lexeme& lx) const -> bool
         {
-            return (lx.m_text == m_text) && (lx.m_type == m_type);
+            if ((m_flags | lx.m_flags) & is_view) {
+                return (lx.m_type == m_type) && (lx.text_view() == text_view());
+            }
+            return (lx.m_symbol == m_symbol) && (lx.m_type == m_type);
         }
 
         /**
@@ -142,7 +203,7 @@ namespace kdl
          */
         [[nodiscard]] auto is(const std::string& value) const -> bool
         {
-            return value == m_text;
+            return value == text_view();
         }
 
         /**
@@ -180,7 +241,19 @@ namespace kdl
          */
         [[nodiscard]] auto type() const -> enum type
         {
-            return m_type;
+            return static_cast<enum type>(m_type);
+        }
+
+        /**
+         * The interned symbol representing the text of the lexeme. Literals are only interned once their symbol
+         * is needed, such as when a string is used as the name of a field.
+         */
+        [[nodiscard]] auto symbol() const -> symbol_table::symbol
+        {
+            if (m_flags & is_view) {
+                return symbol_table::shared().intern(text_view());
+            }
+            return m_symbol;
         }
 
         /**
@@ -189,12 +262,27 @@ namespace kdl
          */
         [[nodiscard]] auto text() const -> std::string
         {
-            return m_text;
+            return std::string(text_view());
+        }
+
+        /**
+         * A view of the textual value of the lexeme. The view is valid for as long as the build, as both the
+         * symbol table and retained sources are.
+         */
+        [[nodiscard]] auto text_view() const -> std::string_view
+        {
+            if (m_flags & is_view) {
+                return source_text(m_source).substr(m_pos, m_symbol);
+            }
+            return symbol_table::shared()[m_symbol].text;
         }
 
         [[nodiscard]] auto components() const -> std::vector<std::string>
         {
-            return m_components;
+            if (m_flags & has_components) {
+                return symbol_table::shared()[m_symbol].components;
+            }
+            return {};
         }
 
         /**
@@ -223,10 +311,30 @@ namespace kdl
             else if (m_type == lexeme::amp) {
                 return 7;
             }
-            else if (m_type == lexeme::res_id && !m_components.empty()) {
-                return static_cast<T>(std::stoll(m_components.back(), nullptr, 10));
+
+            // Numeric values are decoded when the symbol is first interned, or here for literals. Only fall back to
+            // decoding the text if that was not possible, so that the original error reporting is preserved.
+            symbol_table::entry literal;
+            if (m_flags & is_view) {
+                literal.text = text();
+                symbol_table::decode_value(literal.text, literal);
+            }
+            const auto& entry = (m_flags & is_view) ? literal : symbol_table::shared()[m_symbol];
+            if (m_type == lexeme::res_id && (m_flags & has_components) && !entry.components.empty()) {
+                if (entry.has_component_value) {
+                    return static_cast<T>(entry.component_value);
+                }
+                return static_cast<T>(std::stoll(entry.components.back(), nullptr, 10));
+            }
+            else if (entry.has_value) {
+                if (entry.value_is_signed) {
+                    return static_cast<T>(static_cast<std::int64_t>(entry.value));
+                }
+                return static_cast<T>(entry.value);
             }
-            else if (m_text.size() >= 2 && m_text[0] == '-') {
+
+            const auto& m_text = entry.text;
+            if (m_text.size() >= 2 && m_text[0] == '-') {
                // Negative decimal
                return static_cast<T>(std::stoll(m_text, nullptr, 10));
             }
@@ -256,12 +364,26 @@ namespace kdl
         }
 
     private:
-        std::weak_ptr<file> m_owner;
-        std::string m_text;
-        std::size_t m_pos;
-        std::size_t m_offset;
-        std::size_t m_line;
-        std::vector<std::string> m_components;
-        enum type m_type;
+        enum flags : std::uint8_t { has_components = 1 << 0, is_view = 1 << 1 };
+
+        lexeme(enum type type, std::uint32_t pos, std::uint32_t offset, std::uint32_t line, source_id source)
+            : m_source(source), m_pos(pos), m_offset(offset), m_line(line), m_type(type)
+        {
+
+        }
+
+        static auto source_text(source_id source) -> std::string_view;
+
+        // For literals, the symbol and position hold the length and start of the text within the source.
+        symbol_table::symbol m_symbol { 0 };
+        source_id m_source { 0 };
+        std::uint32_t m_pos { 0 };
+        std::uint32_t m_offset { 0 };
+        std::uint32_t m_line { 0 };
+        std::uint8_t m_type { any };
+        std::uint8_t m_flags { 0 };
     };
-};
\ No newline at end of file
+
+    static_assert(sizeof(lexeme) <= 24, "kdl::lexeme is copied throughout the parser and should remain compact.");
+    static_assert(std::is_trivially_copyable<lexeme>::value, "kdl::lexeme should remain trivially copyable.");
+};
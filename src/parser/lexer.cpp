@@ -18,14 +18,13 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
-#include <algorithm>
 #include "parser/lexer.hpp"
 #include "diagnostic/fatal.hpp"
 
 // MARK: - Constructor
 
 kdl::lexer::lexer(std::shared_ptr<file> source)
-    : m_source(source)
+    : m_source(source), m_source_id(lexeme::retain_source(source)), m_text(m_source->view())
 {
 }
 
@@ -37,54 +36,79 @@ auto kdl::lexer::analyze() -> std::vector<lexeme>
         return m_lexemes;
     }
 
-    // Loop through the source code as long as there are characters available to consume.
+    while (scan()) {
+        // Each pass of the scanner appends a single lexeme.
+    }
+
+    return m_lexemes;
+}
+
+auto kdl::lexer::next() -> std::optional<lexeme>
+{
+    // Only the most recent lexeme is retained when streaming, so the memory used does not depend on the size of
+    // the source.
+    m_lexemes.clear();
+    if (!scan()) {
+        return {};
+    }
+    return m_lexemes.back();
+}
+
+auto kdl::lexer::scan() -> bool
+{
+    auto lexeme_count = m_lexemes.size();
+
+    // Loop through the source code as long as there are characters available to consume, stopping as soon as a
+    // lexeme has been produced.
     while (available()) {
 
         // Consume any leading whitespace
-        consume_while(set<' ', '\t'>::contains);
+        consume_while(character_class::whitespace);
 
         // Check if we're looking at a newline. If we are the simply consume it and increment the current line number.
-        if (test_if(match<'\n'>::yes)) {
+        auto c = peek();
+        if (c == '\n') {
             advance();
             m_line++;
             m_offset = 0;
             continue;
         }
-        else if (test_if(match<'\r'>::yes)) {
+        else if (c == '\r') {
             advance();
             continue;
         }
 
         // Check for a comment. If we're looking at a comment then we need to consume the entire line. We need to
         // advance past the character at the end of the match.
-        if (test_if(match<'`'>::yes)) {
-            consume_while(match<'\n'>::no);
+        if (c == '`') {
+            consume_until('\n');
             continue;
         }
 
         // Constructs
-        else if (test_if(match<'@'>::yes)) {
+        else if (c == '@') {
             // We're looking at a directive.
             // Directive's are formed of a @ followed an identifier.
             advance();
-            consume_while(identifier_set::contains);
-            m_lexemes.emplace_back(kdl::lexeme(m_slice, lexeme::directive, m_pos, m_offset, m_line, m_source));
+            consume_while(character_class::identifier);
+            m_lexemes.emplace_back(kdl::lexeme(m_slice, lexeme::directive, m_pos, m_offset, m_line, m_source_id));
         }
 
         // Literals
-        else if (test_if(match<'"'>::yes)) {
+        else if (c == '"') {
             // We're looking at a string literal.
             // The string continues until a corresponding '"' is found.
             advance();
-            consume_while(match<'"'>::no);
-            m_lexemes.emplace_back(kdl::lexeme(m_slice, lexeme::string, m_pos, m_offset, m_line, m_source));
+            auto start = m_pos;
+            consume_until('"');
+            m_lexemes.emplace_back(literal(lexeme::string, start));
             advance();
         }
-        else if (available(0, 5) && test_if([](const std::string hint) -> bool{ return hint == "#auto"; }, 0, 5)) {
+        else if (c == '#' && available(0, 5) && peek(0, 5) == "#auto") {
             // TODO: Expand upon the lexer to handle keywords of this format.
-            m_lexemes.emplace_back(kdl::lexeme(read(1, 4), lexeme::res_id, m_pos, m_offset, m_line, m_source));
+            m_lexemes.emplace_back(kdl::lexeme(read(1, 4), lexeme::res_id, m_pos, m_offset, m_line, m_source_id));
         }
-        else if (test_if(match<'#'>::yes)) {
+        else if (c == '#') {
             // We're looking at a resource id.
             // Check if there is a namespace and a type present. The general format for a resource id is as follows:
             //  #[Namespace.][Type.]ID
@@ -93,190 +117,190 @@ auto kdl::lexer::analyze() -> std::vector<lexeme>
             advance();
 
             std::vector<std::string> components;
-            if (test_if(identifier_set::limited_contains)) {
-                consume_while(identifier_set::contains);
+            if (character_class::is(peek(), character_class::identifier_head)) {
+                consume_while(character_class::identifier);
                 components.emplace_back(m_slice);
                 advance();
             }
 
-            if (test_if(identifier_set::limited_contains)) {
-                consume_while(identifier_set::contains);
+            if (character_class::is(peek(), character_class::identifier_head)) {
+                consume_while(character_class::identifier);
                 components.emplace_back(m_slice);
                 advance();
             }
 
-            auto negative = test_if(match<'-'>::yes);
+            auto negative = (peek() == '-');
             if (negative) {
                 advance();
             }
 
-            consume_while(decimal_set::contains);
+            consume_while(character_class::decimal);
             if (negative) {
-                components.emplace_back("-" + m_slice);
+                components.emplace_back("-" + std::string(m_slice));
             }
             else {
                 components.emplace_back(m_slice);
             }
 
-            m_lexemes.emplace_back(kdl::lexeme(components, lexeme::res_id, m_pos, m_offset, m_line, m_source));
+            m_lexemes.emplace_back(kdl::lexeme(components, lexeme::res_id, m_pos, m_offset, m_line, m_source_id));
         }
-        else if (test_if(match<'$'>::yes) && !m_in_expr) {
+        else if (c == '$' && !m_in_expr) {
             // We're looking at a variable or an expression.
             advance();
 
-            if (test_if(match<'('>::yes)) {
+            if (peek() == '(') {
                 advance();
                 // We're looking at an explicit expression.
-                m_lexemes.emplace_back(kdl::lexeme(m_slice, lexeme::l_expr, m_pos, m_offset, m_line, m_source));
+                m_lexemes.emplace_back(kdl::lexeme(m_slice, lexeme::l_expr, m_pos, m_offset, m_line, m_source_id));
 
                 // Set a flag to indicate that we're in an expression.
                 m_in_expr = true;
             }
             else {
                 // We're looking at an implicit variable expression.
-                consume_while(identifier_set::contains);
-                m_lexemes.emplace_back(kdl::lexeme(m_slice, lexeme::var, m_pos, m_offset, m_line, m_source));
+                consume_while(character_class::identifier);
+                m_lexemes.emplace_back(kdl::lexeme(m_slice, lexeme::var, m_pos, m_offset, m_line, m_source_id));
             }
         }
-        else if (test_if(match<'0'>::yes) && test_if(set<'x', 'X'>::contains, 1)) {
+        else if (c == '0' && (peek(1) == 'x' || peek(1) == 'X')) {
             // We're looking at a hexadecimal number
+            auto start = m_pos;
             advance(2);
-            consume_while(hexadecimal_set::contains);
-            m_lexemes.emplace_back(kdl::lexeme("0x" + m_slice, lexeme::integer, m_pos, m_offset, m_line, m_source));
+            consume_while(character_class::hexadecimal);
+            m_lexemes.emplace_back(literal(lexeme::integer, start));
         }
-        else if (test_if(decimal_set::contains) || (test_if(match<'-'>::yes) && test_if(decimal_set::contains, 1))) {
+        else if (character_class::is(c, character_class::decimal) || (c == '-' && character_class::is(peek(1), character_class::decimal))) {
             // We're looking at a number
-            auto negative = test_if(match<'-'>::yes);
-            if (negative) {
+            auto start = m_pos;
+            if (c == '-') {
                 advance();
             }
 
-            consume_while(decimal_set::contains);
-            auto number_text = m_slice;
-            if (negative) {
-                number_text.insert(0, 1, '-');
-            }
-
-            if (test_if(match<'%'>::yes)) {
-                // This is a percentage.
+            consume_while(character_class::decimal);
+            if (peek() == '%') {
+                // This is a percentage. The '%' is not part of its text.
                 advance();
-                m_lexemes.emplace_back(kdl::lexeme(number_text, lexeme::percentage, m_pos, m_offset, m_line, m_source));
+                m_lexemes.emplace_back(lexeme::literal(lexeme::percentage, start, m_pos - start - 1, m_offset, m_line, m_source_id));
             }
             else {
-                m_lexemes.emplace_back(kdl::lexeme(number_text, lexeme::integer, m_pos, m_offset, m_line, m_source));
+                m_lexemes.emplace_back(literal(lexeme::integer, start));
             }
         }
-        else if (test_if(identifier_set::limited_contains)) {
-            consume_while(identifier_set::contains);
+        else if (character_class::is(c, character_class::identifier_head)) {
+            consume_while(character_class::identifier);
 
             // TODO: Check for keywords
 
-            m_lexemes.emplace_back(kdl::lexeme(m_slice, lexeme::identifier, m_pos, m_offset, m_line, m_source));
+            m_lexemes.emplace_back(kdl::lexeme(m_slice, lexeme::identifier, m_pos, m_offset, m_line, m_source_id));
         }
 
         // Symbols
-        else if (test_if(match<';'>::yes)) {
-            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::semi, m_pos, m_offset, m_line, m_source));
+        else if (c == ';') {
+            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::semi, m_pos, m_offset, m_line, m_source_id));
         }
-        else if (test_if(match<'{'>::yes)) {
-            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::l_brace, m_pos, m_offset, m_line, m_source));
+        else if (c == '{') {
+            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::l_brace, m_pos, m_offset, m_line, m_source_id));
         }
-        else if (test_if(match<'}'>::yes)) {
-            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::r_brace, m_pos, m_offset, m_line, m_source));
+        else if (c == '}') {
+            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::r_brace, m_pos, m_offset, m_line, m_source_id));
         }
-        else if (test_if(match<'['>::yes)) {
-            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::l_bracket, m_pos, m_offset, m_line, m_source));
+        else if (c == '[') {
+            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::l_bracket, m_pos, m_offset, m_line, m_source_id));
         }
-        else if (test_if(match<']'>::yes)) {
-            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::r_bracket, m_pos, m_offset, m_line, m_source));
+        else if (c == ']') {
+            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::r_bracket, m_pos, m_offset, m_line, m_source_id));
         }
-        else if (test_if(match<'('>::yes)) {
-            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::l_paren, m_pos, m_offset, m_line, m_source));
+        else if (c == '(') {
+            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::l_paren, m_pos, m_offset, m_line, m_source_id));
             if (m_in_expr) {
                 m_expr_paren_balance++;
             }
         }
-        else if (test_if(match<')'>::yes) && m_in_expr && m_expr_paren_balance <= 0) {
-            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::r_expr, m_pos, m_offset, m_line, m_source));
+        else if (c == ')' && m_in_expr && m_expr_paren_balance <= 0) {
+            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::r_expr, m_pos, m_offset, m_line, m_source_id));
             m_in_expr = false;
         }
-        else if (test_if(match<')'>::yes)) {
-            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::r_paren, m_pos, m_offset, m_line, m_source));
+        else if (c == ')') {
+            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::r_paren, m_pos, m_offset, m_line, m_source_id));
             if (m_in_expr) {
                 m_expr_paren_balance--;
             }
         }
-        else if (test_if(sequence<'<', '<'>::yes, 0, 2)) {
-            m_lexemes.emplace_back(kdl::lexeme(read(0, 2), lexeme::left_shift, m_pos, m_offset, m_line, m_source));
+        else if (peek(0, 2) == "<<") {
+            m_lexemes.emplace_back(kdl::lexeme(read(0, 2), lexeme::left_shift, m_pos, m_offset, m_line, m_source_id));
         }
-        else if (test_if(sequence<'>', '>'>::yes, 0, 2)) {
-            m_lexemes.emplace_back(kdl::lexeme(read(0, 2), lexeme::right_shift, m_pos, m_offset, m_line, m_source));
+        else if (peek(0, 2) == ">>") {
+            m_lexemes.emplace_back(kdl::lexeme(read(0, 2), lexeme::right_shift, m_pos, m_offset, m_line, m_source_id));
         }
-        else if (test_if(match<'<'>::yes)) {
-            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::l_angle, m_pos, m_offset, m_line, m_source));
+        else if (c == '<') {
+            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::l_angle, m_pos, m_offset, m_line, m_source_id));
         }
-        else if (test_if(match<'>'>::yes)) {
-            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::r_angle, m_pos, m_offset, m_line, m_source));
+        else if (c == '>') {
+            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::r_angle, m_pos, m_offset, m_line, m_source_id));
         }
-        else if (test_if(match<'='>::yes)) {
-            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::equals, m_pos, m_offset, m_line, m_source));
+        else if (c == '=') {
+            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::equals, m_pos, m_offset, m_line, m_source_id));
         }
-        else if (test_if(match<'~'>::yes)) {
-            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::tilde, m_pos, m_offset, m_line, m_source));
+        else if (c == '~') {
+            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::tilde, m_pos, m_offset, m_line, m_source_id));
         }
-        else if (test_if(match<'+'>::yes)) {
-            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::plus, m_pos, m_offset, m_line, m_source));
+        else if (c == '+') {
+            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::plus, m_pos, m_offset, m_line, m_source_id));
         }
-        else if (test_if(match<'-'>::yes)) {
-            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::minus, m_pos, m_offset, m_line, m_source));
+        else if (c == '-') {
+            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::minus, m_pos, m_offset, m_line, m_source_id));
         }
-        else if (test_if(match<'*'>::yes)) {
-            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::star, m_pos, m_offset, m_line, m_source));
+        else if (c == '*') {
+            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::star, m_pos, m_offset, m_line, m_source_id));
         }
-        else if (test_if(match<'/'>::yes)) {
-            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::slash, m_pos, m_offset, m_line, m_source));
+        else if (c == '/') {
+            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::slash, m_pos, m_offset, m_line, m_source_id));
         }
-        else if (test_if(match<'&'>::yes)) {
-            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::amp, m_pos, m_offset, m_line, m_source));
+        else if (c == '&') {
+            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::amp, m_pos, m_offset, m_line, m_source_id));
         }
-        else if (test_if(match<'.'>::yes)) {
-            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::dot, m_pos, m_offset, m_line, m_source));
+        else if (c == '.') {
+            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::dot, m_pos, m_offset, m_line, m_source_id));
         }
-        else if (test_if(match<','>::yes)) {
-            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::comma, m_pos, m_offset, m_line, m_source));
+        else if (c == ',') {
+            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::comma, m_pos, m_offset, m_line, m_source_id));
         }
-        else if (test_if(match<'|'>::yes)) {
-            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::pipe, m_pos, m_offset, m_line, m_source));
+        else if (c == '|') {
+            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::pipe, m_pos, m_offset, m_line, m_source_id));
         }
-        else if (test_if(match<'^'>::yes)) {
-            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::carat, m_pos, m_offset, m_line, m_source));
+        else if (c == '^') {
+            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::carat, m_pos, m_offset, m_line, m_source_id));
         }
-        else if (test_if(match<':'>::yes)) {
-            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::colon, m_pos, m_offset, m_line, m_source));
+        else if (c == ':') {
+            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::colon, m_pos, m_offset, m_line, m_source_id));
         }
-        else if (test_if(match<'!'>::yes)) {
-            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::exclaim, m_pos, m_offset, m_line, m_source));
+        else if (c == '!') {
+            m_lexemes.emplace_back(kdl::lexeme(read(), lexeme::exclaim, m_pos, m_offset, m_line, m_source_id));
         }
 
         // Unrecognised character encountered
         else {
-            log::fatal_error(dummy(), 1, "Unrecognised character '" + peek() + "' encountered.");
+            log::fatal_error(dummy(), 1, "Unrecognised character '" + std::string(1, c) + "' encountered.");
+        }
+
+        if (m_lexemes.size() > lexeme_count) {
+            return true;
         }
     }
 
-    return m_lexemes;
+    return false;
 }
 
 // MARK: - Private Lexer
 
 auto kdl::lexer::dummy(long offset) const -> kdl::lexeme
 {
-    return { "(dummy)", lexeme::star, m_pos + offset, m_offset + offset, m_line, m_source };
+    return { std::string_view("(dummy)"), lexeme::star, m_pos + offset, m_offset + offset, m_line, m_source_id };
 }
 
-auto kdl::lexer::length() const -> std::size_t
+auto kdl::lexer::literal(enum lexeme::type type, std::size_t start) const -> kdl::lexeme
 {
-    return m_source->contents().size();
+    return lexeme::literal(type, start, m_pos - start, m_offset, m_line, m_source_id);
 }
 
 auto kdl::lexer::advance(long offset) -> void
@@ -289,148 +313,48 @@ auto kdl::lexer::available(long offset, std::size_t length) const -> bool
 {
     auto start = m_pos + offset;
     auto end = start + length;
-    return (end <= this->length());
+    return (end <= m_text.size());
+}
+
+auto kdl::lexer::peek(long offset) const -> char
+{
+    if (!available(offset, 1)) {
+        kdl::log::fatal_error(dummy(offset), 1, "Failed to peek '1' characters from source.");
+    }
+    return m_text[m_pos + offset];
 }
 
-auto kdl::lexer::peek(long offset, std::size_t length) const -> std::string
+auto kdl::lexer::peek(long offset, std::size_t length) const -> std::string_view
 {
     if (!available(offset, length)) {
         kdl::log::fatal_error(dummy(offset), 1, "Failed to peek '" + std::to_string(length) + "' characters from source.");
     }
-    return m_source->contents().substr(m_pos + offset, length);
+    return m_text.substr(m_pos + offset, length);
 }
 
 auto kdl::lexer::read(long offset, std::size_t length) -> std::string
 {
-    auto str = peek(offset, length);
+    std::string str(peek(offset, length));
     advance(offset + length);
     return str;
 }
 
-auto kdl::lexer::test_if(const std::function<auto(const std::string&) -> bool>& fn, long offset, std::size_t length) const -> bool
-{
-    return fn(peek(offset, length));
-}
-
-auto kdl::lexer::consume_while(const std::function<auto(const std::string&) -> bool>& fn, std::size_t size) -> bool
+auto kdl::lexer::consume_while(std::uint8_t classes) -> bool
 {
-    m_slice.clear();
-    while (fn(peek(0, size))) {
-        m_slice += read(0, size);
+    auto start = m_pos;
+    while (character_class::is(peek(), classes)) {
+        advance();
     }
+    m_slice = m_text.substr(start, m_pos - start);
     return !m_slice.empty();
 }
 
-// MARK: -
-
-template<char c>
-auto kdl::match<c>::yes(const std::string& __Chk) -> bool
-{
-    return __Chk == std::string(1, c);
-}
-
-
-template <char c>
-auto kdl::match<c>::no(const std::string& __Chk) -> bool
-{
-    return !yes(__Chk);
-}
-
-template<char tC,char...ttC>
-auto kdl::sequence<tC, ttC...>::yes(const std::string& __Chk) -> bool
-{
-    std::vector<char> v = {tC, ttC...};
-    for (auto i = 0; i < v.size(); ++i) {
-        if (__Chk[i] != v[i]) {
-            return false;
-        }
-    }
-    return true;
-}
-
-template<char tC,char...ttC>
-auto kdl::sequence<tC, ttC...>::no(const std::string& __Chk) -> bool
+auto kdl::lexer::consume_until(char terminator) -> bool
 {
-    return !yes(__Chk);
-}
-
-template <char lc, char uc>
-auto kdl::range<lc, uc>::contains(const std::string& __Chk) -> bool
-{
-    for (auto __ch : __Chk) {
-        if (__ch < lc || __ch > uc) {
-            return false;
-        }
-    }
-    return true;
-}
-
-template <char lc, char uc>
-auto kdl::range<lc, uc>::not_contains(const std::string& __Chk) -> bool
-{
-    return !contains(__Chk);
-}
-
-template<char tC, char... ttC>
-auto kdl::set<tC, ttC...>::contains(const std::string& __Chk) -> bool
-{
-    std::vector<char> v = {tC, ttC...};
-
-    for (auto __ch : __Chk) {
-        if (std::find(v.begin(), v.end(), __ch) == v.end()) {
-            return false;
-        }
-    }
-
-    return true;
-}
-
-template<char tC, char... ttC>
-auto kdl::set<tC, ttC...>::not_contains(const std::string& __Chk) -> bool
-{
-    return !contains(__Chk);
-}
-
-auto kdl::identifier_set::contains(const std::string& __Chk) -> bool
-{
-    for (auto __ch : __Chk) {
-        auto condition = (__ch >= 'A' && __ch <= 'Z') || (__ch >= 'a' && __ch <= 'z')  || (__ch >= '0' && __ch <= '9') || __ch == '_';
-        if (!condition) {
-            return false;
-        }
-    }
-    return true;
-}
-
-auto kdl::identifier_set::limited_contains(const std::string& __Chk) -> bool
-{
-    for (auto __ch : __Chk) {
-        auto condition = (__ch >= 'A' && __ch <= 'Z') || (__ch >= 'a' && __ch <= 'z')  || __ch == '_';
-        if (!condition) {
-            return false;
-        }
+    auto start = m_pos;
+    while (peek() != terminator) {
+        advance();
     }
-    return true;
-}
-
-auto kdl::decimal_set::contains(const std::string& __Chk) -> bool
-{
-    for (auto __ch : __Chk) {
-        auto condition = (__ch >= '0' && __ch <= '9');
-        if (!condition) {
-            return false;
-        }
-    }
-    return true;
-}
-
-auto kdl::hexadecimal_set::contains(const std::string& __Chk) -> bool
-{
-    for (auto __ch : __Chk) {
-        auto condition = (__ch >= 'A' && __ch <= 'F') || (__ch >= 'a' && __ch <= 'f') || (__ch >= '0' && __ch <= '9');
-        if (!condition) {
-            return false;
-        }
-    }
-    return true;
+    m_slice = m_text.substr(start, m_pos - start);
+    return !m_slice.empty();
 }
@@ -20,17 +20,74 @@
 
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <type_traits>
-#include <functional>
 #include "parser/file.hpp"
 #include "parser/lexeme.hpp"
 
 namespace kdl
 {
 
+    /**
+     * Character classes used by the lexer. Each byte of the source is looked up in a 256 entry table
+     * once, rather than being tested against a series of individual predicates.
+     */
+    namespace character_class
+    {
+        enum : std::uint8_t
+        {
+            none = 0,
+            whitespace = 1 << 0,
+            identifier_head = 1 << 1,
+            identifier = 1 << 2,
+            decimal = 1 << 3,
+            hexadecimal = 1 << 4,
+        };
+
+        constexpr auto build_table() -> std::array<std::uint8_t, 256>
+        {
+            std::array<std::uint8_t, 256> table {};
+
+            table[static_cast<std::uint8_t>(' ')] |= whitespace;
+            table[static_cast<std::uint8_t>('\t')] |= whitespace;
+
+            for (auto c = 'A'; c <= 'Z'; ++c) {
+                table[static_cast<std::uint8_t>(c)] |= identifier_head | identifier;
+            }
+            for (auto c = 'a'; c <= 'z'; ++c) {
+                table[static_cast<std::uint8_t>(c)] |= identifier_head | identifier;
+            }
+            table[static_cast<std::uint8_t>('_')] |= identifier_head | identifier;
+
+            for (auto c = '0'; c <= '9'; ++c) {
+                table[static_cast<std::uint8_t>(c)] |= identifier | decimal | hexadecimal;
+            }
+            for (auto c = 'A'; c <= 'F'; ++c) {
+                table[static_cast<std::uint8_t>(c)] |= hexadecimal;
+            }
+            for (auto c = 'a'; c <= 'f'; ++c) {
+                table[static_cast<std::uint8_t>(c)] |= hexadecimal;
+            }
+
+            return table;
+        }
+
+        inline constexpr std::array<std::uint8_t, 256> table = build_table();
+
+        /**
+         * Test if the specified character belongs to any of the given classes.
+         */
+        constexpr auto is(char c, std::uint8_t classes) -> bool
+        {
+            return (table[static_cast<std::uint8_t>(c)] & classes) != 0;
+        }
+    };
+
     /**
      * The kdl::lexer class represents a lexical analyser, that will perform lexical analysis on a file,
      * and split it into its component lexemes.
@@ -50,12 +107,22 @@ namespace kdl
          */
         auto analyze() -> std::vector<lexeme>;
 
+        /**
+         * Perform lexical analysis on the next part of the source file only. This allows the source to be read as
+         * a stream of lexemes, without holding all of them at once. A lexer should either be used as a stream, or
+         * have the entire source analyzed, but not both.
+         * @return The next lexeme in the source, or nothing if the end of the source has been reached.
+         */
+        auto next() -> std::optional<lexeme>;
+
     private:
         std::shared_ptr<file> m_source;
+        lexeme::source_id m_source_id { 0 };
+        std::string_view m_text;
         std::size_t m_line { 1 };
         std::size_t m_offset { 0 };
         std::size_t m_pos { 0 };
-        std::string m_slice;
+        std::string_view m_slice;
         bool m_in_expr { false };
         int m_expr_paren_balance { 0 };
         std::vector<lexeme> m_lexemes;
@@ -67,10 +134,16 @@ namespace kdl
         [[nodiscard]] auto dummy(long offset = 0) const -> lexeme;
 
         /**
-         * Reports the length of the source file.
-         * @return The number of characters in the source file.
+         * Generates a literal lexeme, whose text runs from the specified position up to the current position. The
+         * text of a literal is not interned, and instead refers to the source.
          */
-        [[nodiscard]] auto length() const -> std::size_t;
+        [[nodiscard]] auto literal(enum lexeme::type type, std::size_t start) const -> lexeme;
+
+        /**
+         * Scan the source from the current position until a single lexeme has been appended to m_lexemes.
+         * @return true if a lexeme was produced, or false if the end of the source was reached.
+         */
+        auto scan() -> bool;
 
         /**
          * Advance the position of the lexer by the specified offset.
@@ -86,13 +159,20 @@ namespace kdl
          */
         [[nodiscard]] auto available(long offset = 0, std::size_t length = 1) const -> bool;
 
+        /**
+         * Peek a single character from the source without advancing the current position.
+         * @param offset The offset from the current position.
+         * @return A character.
+         */
+        [[nodiscard]] auto peek(long offset = 0) const -> char;
+
         /**
          * Peek a string from the source without advancing the current position.
          * @param offset The offset from the current position.
          * @param length The number of characters required.
-         * @return A string.
+         * @return A view into the source.
          */
-        [[nodiscard]] auto peek(long offset = 0, std::size_t length = 1) const -> std::string;
+        [[nodiscard]] auto peek(long offset, std::size_t length) const -> std::string_view;
 
         /**
          * Read a string from the source advancing the current position, to the end of the read string.
@@ -103,64 +183,21 @@ namespace kdl
         auto read(long offset = 0, std::size_t length = 1) -> std::string;
 
         /**
-         * Test if the specified string from the source, is validated by the provided test function.
-         * @param fn Test function to validate the peek'd string from the source.
-         * @param offset The offset from the current position.
-         * @param length The number of characters required.
-         * @return true if the string was validated.
+         * Consume characters from the source, whilst those characters belong to the specified character
+         * classes. The consumed characters are made available through m_slice.
+         * @param classes The character classes to consume.
+         * @return true if any characters were matched.
          */
-        auto test_if(const std::function<auto(const std::string&) -> bool>& fn, long offset = 0, std::size_t length = 1) const -> bool;
+        auto consume_while(std::uint8_t classes) -> bool;
 
         /**
-         * Consume characters from the source, whilst those characters are validated by the test function.
-         * @param fn Test function to validate each character.
+         * Consume characters from the source, until the specified terminating character is encountered.
+         * The terminating character is not consumed. The consumed characters are made available through
+         * m_slice.
+         * @param terminator The character at which to stop consuming.
          * @return true if any characters were matched.
          */
-        auto consume_while(const std::function<auto(const std::string&) -> bool>& fn, std::size_t size = 1) -> bool;
-    };
-
-    template<char c>
-    struct match
-    {
-        static auto yes(const std::string&) -> bool;
-        static auto no(const std::string&) -> bool;
-    };
-
-    template<char tc,char...ttC>
-    struct sequence
-    {
-        static auto yes(const std::string&) -> bool;
-        static auto no(const std::string&) -> bool;
-    };
-
-    template<char lC, char uC>
-    struct range
-    {
-        static auto contains(const std::string&) -> bool;
-        static auto not_contains(const std::string&) -> bool;
-    };
-
-    template<char tC, char... ttC>
-    struct set
-    {
-        static auto contains(const std::string&) -> bool;
-        static auto not_contains(const std::string&) -> bool;
-    };
-
-    struct identifier_set
-    {
-        static auto limited_contains(const std::string&) -> bool;
-        static auto contains(const std::string&) -> bool;
-    };
-
-    struct decimal_set
-    {
-        static auto contains(const std::string&) -> bool;
-    };
-
-    struct hexadecimal_set
-    {
-        static auto contains(const std::string&) -> bool;
+        auto consume_until(char terminator) -> bool;
     };
 
 };
@@ -18,6 +18,7 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <algorithm>
 #include <stdexcept>
 #include "diagnostic/fatal.hpp"
 #include "parser/parser.hpp"
@@ -30,7 +31,13 @@
 // MARK: - Constructor
 
 kdl::sema::parser::parser(std::weak_ptr<kdl::target> target, const std::vector<kdl::lexeme>& lexemes)
-    : m_target(target), m_lexemes(lexemes), m_ptr(0)
+    : m_target(target)
+{
+    insert(lexemes);
+}
+
+kdl::sema::parser::parser(std::weak_ptr<kdl::target> target, std::shared_ptr<lexer> source)
+    : m_target(target), m_source(std::move(source))
 {
 
 }
@@ -40,25 +47,24 @@ kdl::sema::parser::parser(std::weak_ptr<kdl::target> target, const std::vector<k
 auto kdl::sema::parser::parse() -> void
 {
     auto target = m_target.lock();
-    m_ptr = 0;
 
     while (!finished()) {
 
-        if (expect({ expectation(lexeme::directive, "type").be_true() })) {
+        if (expect(match(lexeme::directive, keyword::type))) {
             auto container = type_definition_parser(*this, m_target).parse(true);
-            target->add_type_container(container);
+            target->add_type_container(std::move(container));
         }
-        else if (expect({ expectation(lexeme::directive, "example").be_true(), expectation(lexeme::identifier, "declare").be_true() })) {
+        else if (expect(sequence(match(lexeme::directive, keyword::example), match(lexeme::identifier, keyword::declare)))) {
             advance();
             declaration_parser(*this, m_target, true).parse();
         }
-        else if (expect_any({ expectation(lexeme::identifier, "component").be_true(), expectation(lexeme::directive, "lua_export").be_true() })) {
+        else if (expect_any(sequence(match(lexeme::identifier, keyword::component), match(lexeme::directive, keyword::lua_export)))) {
             component_parser(*this, m_target).parse();
         }
-        else if (expect({ expectation(lexeme::directive).be_true() })) {
+        else if (expect(match(lexeme::directive))) {
             asm_directive(*this, m_target).parse();
         }
-        else if (expect({ expectation(lexeme::identifier, "declare").be_true() })) {
+        else if (expect(match(lexeme::identifier, keyword::declare))) {
             declaration_parser(*this, m_target).parse();
         }
         else {
@@ -66,7 +72,7 @@ auto kdl::sema::parser::parse() -> void
             log::fatal_error(lx, 1, "Unexpected lexeme '" + lx.text() + "' encountered.");
         }
 
-        ensure({ expectation(lexeme::semi).be_true() });
+        ensure(match(lexeme::semi));
     }
 }
 
@@ -74,10 +80,12 @@ auto kdl::sema::parser::parse() -> void
 
 auto kdl::sema::parser::finished(long offset, long count) const -> bool
 {
-    auto ptr = (m_ptr + offset);
-    auto end_ptr = (ptr + count);
-    auto size = m_lexemes.size();
-    return ptr > size || end_ptr > size;
+    if (offset + count > 0) {
+        fill(static_cast<std::size_t>(offset + count));
+    }
+
+    auto remaining = static_cast<long>(m_remaining);
+    return offset > remaining || (offset + count) > remaining;
 }
 
 auto kdl::sema::parser::consume(kdl::sema::expectation::function expect) -> std::vector<lexeme>
@@ -92,46 +100,95 @@ auto kdl::sema::parser::consume(kdl::sema::expectation::function expect) -> std:
 auto kdl::sema::parser::advance(long delta) -> void
 {
     for (auto n = 0; n < delta; ++n) {
-        if (!m_tmp_lexemes.empty()) {
-            m_tmp_lexemes.erase(m_tmp_lexemes.begin());
+        if (pushed_count() > 0) {
+            m_tmp_ptr++;
         }
         else {
-            m_ptr++;
+            advance_stream();
         }
     }
 }
 
+auto kdl::sema::parser::advance_stream() -> void
+{
+    if (m_streams.empty()) {
+        // Every stream has been read, so continue with the streamed source.
+        fill(1);
+        if (!m_lookahead.empty()) {
+            m_previous = m_lookahead.front();
+            m_lookahead.pop_front();
+            m_remaining--;
+        }
+        return;
+    }
+
+    auto& stream = m_streams.back();
+    m_previous = (*stream.lexemes)[stream.position++];
+    m_remaining--;
+
+    // Once a stream has been exhausted, resume reading from the one beneath it.
+    if (stream.remaining() == 0) {
+        m_streams.pop_back();
+    }
+}
+
 auto kdl::sema::parser::push(std::initializer_list<lexeme> lexemes) -> void
 {
     m_tmp_lexemes = std::vector<lexeme>(lexemes);
+    m_tmp_ptr = 0;
 }
 
 auto kdl::sema::parser::clear_pushed_lexemes() -> void
 {
     m_tmp_lexemes.clear();
+    m_tmp_ptr = 0;
+}
+
+auto kdl::sema::parser::pushed_count() const -> std::size_t
+{
+    return m_tmp_lexemes.size() - m_tmp_ptr;
 }
 
 auto kdl::sema::parser::peek(long offset) const -> kdl::lexeme
 {
-    if (!m_tmp_lexemes.empty() && (offset >= 0 || offset < m_tmp_lexemes.size())) {
-        return m_tmp_lexemes.at(offset);
+    if (pushed_count() > 0) {
+        return m_tmp_lexemes.at(m_tmp_ptr + offset);
     }
     if (finished(offset, 1)) {
         throw std::logic_error("[kdl::sema::parser] Attempted to access lexeme beyond end of stream.");
     }
-    return m_lexemes[m_ptr + offset];
+
+    // Only the most recently consumed lexeme is retained for looking behind the current position.
+    if (offset < 0) {
+        if (offset == -1 && m_previous.has_value()) {
+            return m_previous.value();
+        }
+        throw std::logic_error("[kdl::sema::parser] Attempted to access lexeme before start of stream.");
+    }
+
+    auto remaining = static_cast<std::size_t>(offset);
+    for (auto it = m_streams.rbegin(); it != m_streams.rend(); ++it) {
+        if (remaining < it->remaining()) {
+            return (*it->lexemes)[it->position + remaining];
+        }
+        remaining -= it->remaining();
+    }
+
+    if (remaining < m_lookahead.size()) {
+        return m_lookahead[remaining];
+    }
+
+    throw std::logic_error("[kdl::sema::parser] Attempted to access lexeme beyond end of stream.");
 }
 
 auto kdl::sema::parser::read(long offset) -> kdl::lexeme
 {
     auto Tk = peek(offset);
-    if (m_tmp_lexemes.empty() || (offset >= m_tmp_lexemes.size())) {
+    if (pushed_count() == 0 || (offset >= pushed_count())) {
         advance(offset + 1);
     }
     else {
-        for (auto n = 0; n <= offset; ++n) {
-            m_tmp_lexemes.erase(m_tmp_lexemes.begin());
-        }
+        m_tmp_ptr += offset + 1;
     }
     return Tk;
 }
@@ -140,7 +197,7 @@ auto kdl::sema::parser::expect(std::initializer_list<kdl::sema::expectation::fun
 {
     auto ptr = 0;
     for (auto f : expect) {
-        if (m_ptr + ptr >= size() || f(peek(ptr++)) == false) {
+        if (finished(ptr) || f(peek(ptr++)) == false) {
             return false;
         }
     }
@@ -172,30 +229,129 @@ auto kdl::sema::parser::ensure(std::initializer_list<kdl::sema::expectation::fun
     }
 }
 
+auto kdl::sema::parser::expect(const match& m) const -> bool
+{
+    return !finished() && m.matches(peek());
+}
+
+auto kdl::sema::parser::ensure(const match& m) -> void
+{
+    auto Tk = read();
+    if (!m.matches(Tk)) {
+        log::fatal_error(Tk, 1, "Could not ensure the correctness of the token '" + Tk.text() + "'");
+    }
+}
+
+// MARK: - Streamed Source
+
+auto kdl::sema::parser::fill(std::size_t count) const -> void
+{
+    while (m_source && m_remaining < count) {
+        auto lx = m_source->next();
+        if (!lx.has_value()) {
+            // The source has been exhausted, so there is no need to keep hold of it.
+            m_source = nullptr;
+            break;
+        }
+
+        m_lookahead.emplace_back(lx.value());
+        m_remaining++;
+        m_size++;
+    }
+}
+
+auto kdl::sema::parser::spill_lookahead(std::size_t count) -> void
+{
+    if (count == 0) {
+        return;
+    }
+
+    auto end = m_lookahead.begin() + static_cast<long>(count);
+    auto lexemes = std::make_shared<const std::vector<lexeme>>(m_lookahead.begin(), end);
+    m_lookahead.erase(m_lookahead.begin(), end);
+
+    // The look ahead is always read after every stream, so the spilled lexemes become the last stream.
+    m_streams.insert(m_streams.begin(), stream { lexemes, 0, count });
+}
+
 // MARK: - Lexeme Insertion
 
 auto kdl::sema::parser::insert(const std::vector<lexeme>& lexemes, const int offset) -> void
 {
-    if (finished(offset, 1)) {
-        // We trying to insert at the end of the stream.
-        m_lexemes.insert(m_lexemes.end(), lexemes.begin(), lexemes.end());
+    insert(std::make_shared<const std::vector<lexeme>>(lexemes), offset);
+}
+
+auto kdl::sema::parser::insert(std::vector<lexeme>&& lexemes, const int offset) -> void
+{
+    insert(std::make_shared<const std::vector<lexeme>>(std::move(lexemes)), offset);
+}
+
+auto kdl::sema::parser::insert(std::shared_ptr<const std::vector<lexeme>> lexemes, const int offset) -> void
+{
+    if (lexemes->empty()) {
+        return;
+    }
+
+    stream inserted { lexemes, 0, lexemes->size() };
+
+    std::size_t stream_remaining = 0;
+    for (const auto& existing : m_streams) {
+        stream_remaining += existing.remaining();
+    }
+
+    auto position = static_cast<std::size_t>(std::max(offset, 0));
+    if (position >= stream_remaining) {
+        // We're inserting after every existing stream. Any lexemes from the streamed source that come before the
+        // insertion point need to be moved out of the way first, so that they are still read before the new ones.
+        fill(position);
+        spill_lookahead(std::min(position - stream_remaining, m_lookahead.size()));
+        m_streams.insert(m_streams.begin(), inserted);
     }
     else {
-        // We're inserting mid stream.
-        auto insertion_ptr = m_lexemes.begin() + m_ptr + offset;
-        m_lexemes.insert(insertion_ptr, lexemes.begin(), lexemes.end());
+        // We're inserting mid stream. Find the stream that contains the insertion point and split it, so that the
+        // new lexemes are read between the two halves.
+        auto remaining = static_cast<std::size_t>(offset);
+        for (auto i = m_streams.size(); i-- > 0;) {
+            auto& tail = m_streams[i];
+            if (remaining >= tail.remaining()) {
+                remaining -= tail.remaining();
+                continue;
+            }
+
+            stream head { tail.lexemes, tail.position, tail.position + remaining };
+            tail.position = head.end;
+
+            auto it = m_streams.insert(m_streams.begin() + static_cast<long>(i) + 1, inserted);
+            if (head.remaining() > 0) {
+                m_streams.insert(it + 1, head);
+            }
+            break;
+        }
     }
+
+    m_remaining += inserted.remaining();
+    m_size += inserted.remaining();
 }
 
 auto kdl::sema::parser::import(const std::string& source_name, const std::string &source) -> void
 {
+    auto target = m_target.lock();
+    if (auto lexemes = target ? target->cached_import(source_name) : nullptr) {
+        insert(lexemes, 1);
+        return;
+    }
+
     auto lexer = kdl::lexer(std::make_shared<kdl::file>(source_name, source));
-    insert(lexer.analyze(), 1);
+    auto lexemes = std::make_shared<const std::vector<lexeme>>(lexer.analyze());
+    if (target) {
+        target->cache_import(source_name, lexemes);
+    }
+    insert(lexemes, 1);
 }
 
 // MARK: - Accessors
 
 auto kdl::sema::parser::size() const -> std::size_t
 {
-    return m_lexemes.size();
+    return m_size;
 }
\ No newline at end of file
@@ -20,12 +20,19 @@
 
 #pragma once
 
+#include <deque>
 #include <memory>
 #include <vector>
 #include <optional>
 #include "parser/lexeme.hpp"
 #include "target/target.hpp"
 #include "parser/expectation.hpp"
+#include "parser/pattern.hpp"
+
+namespace kdl
+{
+    class lexer;
+}
 
 namespace kdl::sema
 {
@@ -44,6 +51,16 @@ namespace kdl::sema
          */
         parser(std::weak_ptr<target> target, const std::vector<lexeme>& lexemes);
 
+        /**
+         * Construct a new parser for the specified target, that reads its lexemes from a lexer as they are needed.
+         * Only the lexemes that the parser is currently looking ahead at are held, rather than the entire source.
+         * The text of each distinct token is still interned in the symbol table for the rest of the build, and the
+         * contents of the source file are held until the lexer is released.
+         * @param target The destination target of the parser.
+         * @param source The lexer from which lexemes will be read.
+         */
+        parser(std::weak_ptr<target> target, std::shared_ptr<lexer> source);
+
         /**
          * Parse the lexeme stream into/against the target.
          */
@@ -119,23 +136,103 @@ namespace kdl::sema
         auto ensure(std::initializer_list<expectation::function> expect) -> void;
 
         /**
-         * Insert new lexemes into the parser at the current location.
+         * Validate the upcoming lexemes against a match or pattern. These behave in the same way as the
+         * expectation based variants, but do not need to allocate or copy anything to perform the test.
+         */
+        [[nodiscard]] auto expect(const match& m) const -> bool;
+        auto ensure(const match& m) -> void;
+
+        template<std::size_t N>
+        [[nodiscard]] auto expect(const pattern<N>& p) const -> bool
+        {
+            for (std::size_t i = 0; i < N; ++i) {
+                if (finished(i) || !p[i].matches(peek(i))) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        template<std::size_t N>
+        [[nodiscard]] auto expect_any(const pattern<N>& p) const -> bool
+        {
+            auto lx = peek();
+            for (const auto& m : p) {
+                if (m.matches(lx)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        template<std::size_t N>
+        auto ensure(const pattern<N>& p) -> void
+        {
+            for (const auto& m : p) {
+                ensure(m);
+            }
+        }
+
+        /**
+         * Insert new lexemes into the parser at the current location. The lexemes are added as a new stream
+         * that is read before the remainder of the existing stream, so no existing lexemes are moved.
          * @param lexemes The list of lexemes to be inserted.
          */
         auto insert(const std::vector<lexeme>& lexemes, int offset = 0) -> void;
+        auto insert(std::vector<lexeme>&& lexemes, int offset = 0) -> void;
+        auto insert(std::shared_ptr<const std::vector<lexeme>> lexemes, int offset = 0) -> void;
 
         /**
-         * Parse a KDL source string in the Lexer and immediately import the lexemes.
+         * Parse a KDL source string in the Lexer and immediately import the lexemes. The result of lexical
+         * analysis is cached on the target against the source name.
          */
         auto import(const std::string& source_name, const std::string& source) -> void;
 
+        /**
+         * The number of lexemes that have been given to the parser. For a streamed source, this only includes the
+         * lexemes that have been read from it so far.
+         */
         [[nodiscard]] auto size() const -> std::size_t;
 
     private:
+        /**
+         * A range of lexemes that are yet to be read by the parser. Imports are pushed as new streams on top
+         * of the stream that is currently being read, splitting it if required.
+         */
+        struct stream
+        {
+            std::shared_ptr<const std::vector<lexeme>> lexemes;
+            std::size_t position { 0 };
+            std::size_t end { 0 };
+
+            [[nodiscard]] auto remaining() const -> std::size_t { return end - position; }
+        };
+
         std::weak_ptr<target> m_target;
-        std::size_t m_ptr { 0 };
-        std::vector<lexeme> m_lexemes;
+        std::vector<stream> m_streams;
+        mutable std::shared_ptr<lexer> m_source;
+        mutable std::deque<lexeme> m_lookahead;
+        mutable std::size_t m_remaining { 0 };
+        mutable std::size_t m_size { 0 };
+        std::optional<lexeme> m_previous;
         std::vector<lexeme> m_tmp_lexemes;
+        std::size_t m_tmp_ptr { 0 };
+
+        [[nodiscard]] auto pushed_count() const -> std::size_t;
+        auto advance_stream() -> void;
+
+        /**
+         * Read lexemes from the streamed source, if there is one, until at least the specified number of lexemes
+         * are available to the parser or the source is exhausted. The lexemes of the streamed source are always
+         * read after those of every stream.
+         */
+        auto fill(std::size_t count) const -> void;
+
+        /**
+         * Move the specified number of lexemes from the front of the look ahead into a stream of their own, so that
+         * new lexemes can be inserted after them.
+         */
+        auto spill_lookahead(std::size_t count) -> void;
     };
 
 }
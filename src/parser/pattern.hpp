@@ -0,0 +1,82 @@
+// Copyright (c) 2022 Tom Hancocks
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <limits>
+#include "parser/lexeme.hpp"
+#include "parser/keyword.hpp"
+
+namespace kdl::sema
+{
+
+    /**
+     * A match describes what a single lexeme is expected to be, by its type and optionally by its symbol. Unlike
+     * an expectation, a match is a plain value that can be constructed at compile time and tested against a
+     * lexeme without allocating or copying any text.
+     */
+    struct match
+    {
+    public:
+        static constexpr symbol_table::symbol any_symbol = std::numeric_limits<symbol_table::symbol>::max();
+
+        constexpr explicit match(enum lexeme::type type, symbol_table::symbol symbol = any_symbol, bool expected = true)
+            : m_type(type), m_symbol(symbol), m_expected(expected)
+        {
+
+        }
+
+        /**
+         * A match that is met by any lexeme that does not meet this match.
+         */
+        [[nodiscard]] constexpr auto operator!() const -> match
+        {
+            return match(m_type, m_symbol, !m_expected);
+        }
+
+        [[nodiscard]] auto matches(const lexeme& lx) const -> bool
+        {
+            auto outcome = (m_type == lexeme::any || lx.type() == m_type)
+                        && (m_symbol == any_symbol || lx.symbol() == m_symbol);
+            return outcome == m_expected;
+        }
+
+    private:
+        enum lexeme::type m_type { lexeme::any };
+        symbol_table::symbol m_symbol { any_symbol };
+        bool m_expected { true };
+    };
+
+    /**
+     * A pattern is a fixed sequence of matches, that are tested against consecutive lexemes.
+     */
+    template<std::size_t N>
+    using pattern = std::array<match, N>;
+
+    template<typename... M>
+    constexpr auto sequence(M... matches) -> pattern<sizeof...(M)>
+    {
+        return {{ matches... }};
+    }
+
+}
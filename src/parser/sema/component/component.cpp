@@ -108,10 +108,20 @@ auto kdl::sema::component::set_export_types(const std::vector<lexeme> &types) ->
 
 // MARK: - Resource Generation
 
-auto kdl::sema::component::generate_resources(const std::shared_ptr<target>& target) const -> void
+auto kdl::sema::component::reserve_ids(const std::shared_ptr<target>& target, const std::string& type_code, std::size_t count) const -> void
+{
+    // The ids of a component are reserved as a single range, so that resources declared with #auto are never
+    // allocated an id within it.
+    if (count > 0) {
+        target->reserve_resource_ids(type_code, m_base_id, m_base_id + static_cast<int64_t>(count) - 1);
+    }
+}
+
+auto kdl::sema::component::generate_resources(const std::shared_ptr<target>& target, const kdl::lexeme& declaration) const -> void
 {
     // Fetch the type container for the resources...
-    auto container = target->type_container_named(m_as_type);
+    const auto& container = target->type_container_named(m_as_type);
+    reserve_ids(target, container.code(), m_files.size());
 
     // Iterate through each of the files and produce a resource for it.
     int64_t id = m_base_id;
@@ -122,32 +132,33 @@ auto kdl::sema::component::generate_resources(const std::shared_ptr<target>& tar
             log::fatal_error(lexeme(path, lexeme::string), 1, "Failed to find component file at: " + path);
         }
 
-        const auto& contents = kdl::file(path).contents();
+        kdl::file component_file(path);
 
         build_target::resource_constructor resource(target,
                                                     id++,
                                                     container.code(),
                                                     file.name.has_value() ? file.name.value() : "",
-                                                    contents);
+                                                    component_file.view());
 
         // Set up the attributes of the resource.
         resource.set_attribute("namespace", m_namespace);
 
-        target->add_resource(resource);
+        target->add_resource(resource, declaration);
     }
 }
 
 // MARK: - Lua Generation
 
-auto kdl::sema::component::synthesize_lua_from_types(const std::shared_ptr<target> &target) const -> void
+auto kdl::sema::component::synthesize_lua_from_types(const std::shared_ptr<target> &target, const kdl::lexeme& declaration) const -> void
 {
     // Fetch the type container for the resources...
-    auto container = target->type_container_named(m_as_type);
+    const auto& container = target->type_container_named(m_as_type);
+    reserve_ids(target, container.code(), m_export_types.size());
 
     // Iterate through each of the types and produce a resource for it.
     int64_t id = m_base_id;
     for (const auto& type_name : m_export_types) {
-        auto type = target->type_container_named(type_name);
+        const auto& type = target->type_container_named(type_name);
         codegen::lua::type_exporter exporter(type);
         auto lua = exporter.generate_lua();
 
@@ -160,6 +171,6 @@ auto kdl::sema::component::synthesize_lua_from_types(const std::shared_ptr<targe
         // Set up the attributes of the resource.
         resource.set_attribute("namespace", m_namespace);
 
-        target->add_resource(resource);
+        target->add_resource(resource, declaration);
     }
 }
\ No newline at end of file
@@ -71,8 +71,8 @@ namespace kdl::sema
 
         auto set_export_types(const std::vector<lexeme>& types) -> void;
 
-        auto generate_resources(const std::shared_ptr<target>& target) const -> void;
-        auto synthesize_lua_from_types(const std::shared_ptr<target>& target) const -> void;
+        auto generate_resources(const std::shared_ptr<target>& target, const kdl::lexeme& declaration) const -> void;
+        auto synthesize_lua_from_types(const std::shared_ptr<target>& target, const kdl::lexeme& declaration) const -> void;
 
     private:
         enum mode m_mode;
@@ -84,6 +84,8 @@ namespace kdl::sema
         std::int64_t m_base_id { 128 };
         std::vector<file> m_files;
         std::vector<lexeme> m_export_types;
+
+        auto reserve_ids(const std::shared_ptr<target>& target, const std::string& type_code, std::size_t count) const -> void;
     };
 
 }
@@ -127,11 +127,11 @@ auto kdl::sema::component_parser::parse() -> void
     // At this point we need to actually do something with the component.
     switch (mode) {
         case component::mode::import_file: {
-            m_component.generate_resources(target);
+            m_component.generate_resources(target, component_name);
             break;
         }
         case component::mode::export_lua_as_resource: {
-            m_component.synthesize_lua_from_types(target);
+            m_component.synthesize_lua_from_types(target, component_name);
             break;
         }
     }
@@ -40,23 +40,19 @@ auto kdl::sema::declaration_parser::parse() -> std::vector<kdl::build_target::re
     }
     auto target = m_target.lock();
 
-    m_parser.ensure({ expectation(lexeme::identifier, "declare").be_true() });
+    m_parser.ensure(match(lexeme::identifier, keyword::declare));
 
     // We need to determine if we're being supplied a namespace or not.
     kdl::lexeme type_name { "", lexeme::any };
     kdl::lexeme ns { "", lexeme::any };
 
-    if (m_parser.expect({
-        expectation(lexeme::identifier).be_true(), expectation(lexeme::dot).be_true(), expectation(lexeme::identifier).be_true()
-    })) {
+    if (m_parser.expect(sequence(match(lexeme::identifier), match(lexeme::dot), match(lexeme::identifier)))) {
         // Format is: Namespace.Type
         ns = m_parser.read();
         m_parser.advance();
         type_name = m_parser.read();
     }
-    else if (m_parser.expect({
-        expectation(lexeme::identifier).be_true(), expectation(lexeme::dot).be_false()
-    })) {
+    else if (m_parser.expect(sequence(match(lexeme::identifier), !match(lexeme::dot)))) {
         // Format is: Type
         type_name = m_parser.read();
     }
@@ -64,23 +60,23 @@ auto kdl::sema::declaration_parser::parse() -> std::vector<kdl::build_target::re
         log::fatal_error(m_parser.peek(), 1, "Expected resource type name.");
     }
 
-    auto type = target->type_container_named(type_name);
+    const auto& type = target->type_container_named(type_name);
 
     std::vector<kdl::build_target::resource_constructor> instances;
-    m_parser.ensure({ expectation(lexeme::l_brace).be_true() });
-    while (m_parser.expect({ expectation(lexeme::r_brace).be_false() })) {
+    m_parser.ensure(match(lexeme::l_brace));
+    while (m_parser.expect(!match(lexeme::r_brace))) {
         kdl::sema::resource_instance_parser parser(m_parser, type, m_target, m_discards);
         if (ns.is(lexeme::identifier)) {
             parser.add_attribute("namespace", ns.text());
         }
 
-        if (m_parser.expect({ expectation(lexeme::identifier, "new").be_true() })) {
+        if (m_parser.expect(match(lexeme::identifier, keyword::new_))) {
             parser.set_keyword("new");
         }
-        else if (m_parser.expect({ expectation(lexeme::identifier, "override").be_true() })) {
+        else if (m_parser.expect(match(lexeme::identifier, keyword::override_))) {
             parser.set_keyword("override");
         }
-        else if (m_parser.expect({ expectation(lexeme::identifier, "duplicate").be_true() })) {
+        else if (m_parser.expect(match(lexeme::identifier, keyword::duplicate))) {
             parser.set_keyword("duplicate");
         }
         else {
@@ -88,9 +84,9 @@ auto kdl::sema::declaration_parser::parse() -> std::vector<kdl::build_target::re
         }
 
         instances.emplace_back(parser.parse());
-        m_parser.ensure({ expectation(lexeme::semi).be_true() });
+        m_parser.ensure(match(lexeme::semi));
     }
-    m_parser.ensure({ expectation(lexeme::r_brace).be_true() });
+    m_parser.ensure(match(lexeme::r_brace));
     return instances;
 }
 
@@ -31,7 +31,7 @@
 
 // MARK: - Constructor
 
-kdl::sema::field_parser::field_parser(kdl::sema::parser &parser, build_target::type_container& type, build_target::resource_constructor& instance, std::weak_ptr<target> target)
+kdl::sema::field_parser::field_parser(kdl::sema::parser &parser, const build_target::type_container& type, build_target::resource_constructor& instance, std::weak_ptr<target> target)
     : m_parser(parser), m_instance(instance), m_type(type), m_target(std::move(target))
 {
 
@@ -41,15 +41,15 @@ kdl::sema::field_parser::field_parser(kdl::sema::parser &parser, build_target::t
 
 auto kdl::sema::field_parser::parse() -> void
 {
-    if (m_parser.expect({ expectation(lexeme::directive, "hint").be_true() })) {
+    if (m_parser.expect(match(lexeme::directive, keyword::hint))) {
         sema::hint_directive_parser::parse(m_parser, m_target);
     }
 
-    if (!m_parser.expect({ expectation(lexeme::identifier).be_true() })) {
+    if (!m_parser.expect(match(lexeme::identifier))) {
         log::fatal_error(m_parser.peek(), 1, "Expected an identifier for the field name.");
     }
     auto field_name = m_parser.read();
-    auto field = m_type.field_named(field_name);
+    const auto& field = m_type.field_named(field_name);
 
     if (field.has_repeatable_count_field()) {
         field_name = field.repeatable_count_field();
@@ -64,9 +64,9 @@ auto kdl::sema::field_parser::parse() -> void
         log::fatal_error(field_name, 1, "Attempted to reference field '" + field_name.text() + "' more than once.");
     }
 
-    m_parser.ensure({ expectation(lexeme::equals).be_true() });
+    m_parser.ensure(match(lexeme::equals));
 
-    if (field.expected_values() > 1 && m_parser.expect({ expectation(lexeme::l_brace).be_true() })) {
+    if (field.expected_values() > 1 && m_parser.expect(match(lexeme::l_brace))) {
         // We're looking at multi value field, and its being provided as an explicit object.
         m_parser.advance();
 
@@ -75,22 +75,22 @@ auto kdl::sema::field_parser::parse() -> void
             apply_defaults_for_field(field);
             m_parser.clear_pushed_lexemes();
 
-            while (m_parser.expect({ expectation(lexeme::r_brace).be_false() })) {
-                if (!m_parser.expect({ expectation(lexeme::identifier).be_true() })) {
+            while (m_parser.expect(!match(lexeme::r_brace))) {
+                if (!m_parser.expect(match(lexeme::identifier))) {
                     log::fatal_error(m_parser.peek(), 1, "Expected an identifier for the field name.");
                 }
                 auto sub_field_name = m_parser.read();
-                auto field_value = field.value_named(sub_field_name);
+                const auto& field_value = field.value_named(sub_field_name);
 
-                m_parser.ensure({ expectation(lexeme::equals).be_true() });
+                m_parser.ensure(match(lexeme::equals));
 
                 parse_value(field, field_value, lock);
 
-                m_parser.ensure({ expectation(lexeme::semi).be_true() });
+                m_parser.ensure(match(lexeme::semi));
             }
         });
 
-        m_parser.ensure({ expectation(lexeme::r_brace).be_true() });
+        m_parser.ensure(match(lexeme::r_brace));
     }
     else if (field.has_repeatable_count_field()) {
         m_instance.add_list_element(field_name, [&] (build_target::resource_constructor *resource) {
@@ -98,32 +98,28 @@ auto kdl::sema::field_parser::parse() -> void
             apply_defaults_for_field(field);
             m_parser.clear_pushed_lexemes();
 
-            auto value = field.value_at(0);
-            parse_value(field, value, lock);
+            parse_value(field, field.value_at(0), lock);
         });
     }
     else {
         for (auto n = 0; n < field.expected_values(); ++n) {
-            auto value = field.value_at(n);
-            parse_value(field, value, lock);
+            parse_value(field, field.value_at(n), lock);
         }
     }
 }
 
-auto kdl::sema::field_parser::parse_value(kdl::build_target::type_field& field, kdl::build_target::type_field_value& field_value, std::int32_t field_number) -> void
+auto kdl::sema::field_parser::parse_value(const kdl::build_target::type_field& field, const kdl::build_target::type_field_value& field_value, std::int32_t field_number) -> void
 {
     const auto& field_name = field.name();
 
     // TODO: Fix this hack...
     std::vector<build_target::type_template::binary_field> binary_fields;
     for (auto i = 0; i <= field_value.joined_value_count(); ++i) {
-        auto extended_name = (i == 0 ? field_value : field_value.joined_value_at(i - 1)).extended_name({
-            std::pair("FieldNumber", lexeme(std::to_string(field_number), lexeme::integer))
-        });
+        auto extended_name = (i == 0 ? field_value : field_value.joined_value_at(i - 1)).extended_name(field_number);
         binary_fields.emplace_back(m_type.internal_template().binary_field_named(extended_name));
     }
 
-    if (m_parser.expect({ expectation(lexeme::semi).be_true() })) {
+    if (m_parser.expect(match(lexeme::semi))) {
         // There are no more values provided for the field, so we need to use default values.
         if (field_value.default_value().has_value()) {
             m_parser.push({
@@ -136,14 +132,11 @@ auto kdl::sema::field_parser::parse_value(kdl::build_target::type_field& field,
     }
 
     // Is the value a pre-defined symbol.
-    if (m_parser.expect({ expectation(lexeme::identifier).be_true() })) {
+    if (m_parser.expect(match(lexeme::identifier))) {
         auto symbol = m_parser.peek();
-        for (const auto& it : field_value.symbols()) {
-            if (std::get<0>(it).is(symbol.text())) {
-                m_parser.advance();
-                m_parser.push({ std::get<1>(it) });
-                break;
-            }
+        if (field_value.has_symbol(symbol)) {
+            m_parser.advance();
+            m_parser.push({ field_value.value_for(symbol) });
         }
     }
 
@@ -156,8 +149,8 @@ auto kdl::sema::field_parser::parse_value(kdl::build_target::type_field& field,
     }
 }
 
-auto kdl::sema::field_parser::parse_explicit_typed_value(kdl::build_target::type_field &field,
-                                                         kdl::build_target::type_field_value &field_value,
+auto kdl::sema::field_parser::parse_explicit_typed_value(const kdl::build_target::type_field &field,
+                                                         const kdl::build_target::type_field_value &field_value,
                                                          std::vector<build_target::type_template::binary_field>& binary_fields) -> void
 {
     auto explicit_type = field_value.explicit_type().value();
@@ -180,8 +173,8 @@ auto kdl::sema::field_parser::parse_explicit_typed_value(kdl::build_target::type
     }
 }
 
-auto kdl::sema::field_parser::parse_implicitly_typed_value(kdl::build_target::type_field& field,
-                                                           kdl::build_target::type_field_value& field_value,
+auto kdl::sema::field_parser::parse_implicitly_typed_value(const kdl::build_target::type_field& field,
+                                                           const kdl::build_target::type_field_value& field_value,
                                                            std::vector<build_target::type_template::binary_field>& binary_fields) -> void
 {
     implicit_value_parser(m_parser, m_target, field, field_value, binary_fields.back())
@@ -194,7 +187,7 @@ auto kdl::sema::field_parser::apply_defaults_for_field(const build_target::type_
     if (type_field.has_repeatable_count_field()) {
         field_name = type_field.repeatable_count_field();
     }
-    auto field = m_type.field_named(type_field.name());
+    const auto& field = m_type.field_named(type_field.name());
 
     auto lower = field.lower_repeat_bound();
     auto upper = type_field.has_repeatable_count_field() ? lower : field.upper_repeat_bound();
@@ -207,7 +200,7 @@ auto kdl::sema::field_parser::apply_defaults_for_field(const build_target::type_
 
         // Iterate over the expected values for the field.
         for (auto n = 0; n < field.expected_values(); ++n) {
-            auto field_value = field.value_at(n);
+            const auto& field_value = field.value_at(n);
 
             // Do we have a default value - if not break out of this value and move to the next field.
             if (!field_value.default_value().has_value()) {
@@ -217,9 +210,7 @@ auto kdl::sema::field_parser::apply_defaults_for_field(const build_target::type_
             // Handle joined/merged values
             std::vector<build_target::type_template::binary_field> binary_fields;
             for (auto i = 0; i <= field_value.joined_value_count(); ++i) {
-                auto extended_name = (i == 0 ? field_value : field_value.joined_value_at(i - 1)).extended_name({
-                    std::pair("FieldNumber", lexeme(std::to_string(lock), lexeme::integer))
-                });
+                auto extended_name = (i == 0 ? field_value : field_value.joined_value_at(i - 1)).extended_name(lock);
                 binary_fields.emplace_back(m_type.internal_template().binary_field_named(extended_name));
             }
 
@@ -28,7 +28,7 @@ namespace kdl::sema
     class field_parser
     {
     public:
-        field_parser(parser& parser, build_target::type_container& type, build_target::resource_constructor& instance, std::weak_ptr<target> target);
+        field_parser(parser& parser, const build_target::type_container& type, build_target::resource_constructor& instance, std::weak_ptr<target> target);
 
         auto parse() -> void;
 
@@ -36,13 +36,13 @@ namespace kdl::sema
 
     private:
         parser& m_parser;
-        build_target::type_container& m_type;
+        const build_target::type_container& m_type;
         build_target::resource_constructor& m_instance;
         std::weak_ptr<target> m_target;
 
-        auto parse_value(kdl::build_target::type_field& field, kdl::build_target::type_field_value& field_value, std::int32_t field_number = -1) -> void;
-        auto parse_explicit_typed_value(kdl::build_target::type_field& field, kdl::build_target::type_field_value& field_value, std::vector<build_target::type_template::binary_field>&) -> void;
-        auto parse_implicitly_typed_value(kdl::build_target::type_field& field, kdl::build_target::type_field_value& field_value, std::vector<build_target::type_template::binary_field>&) -> void;
+        auto parse_value(const kdl::build_target::type_field& field, const kdl::build_target::type_field_value& field_value, std::int32_t field_number = -1) -> void;
+        auto parse_explicit_typed_value(const kdl::build_target::type_field& field, const kdl::build_target::type_field_value& field_value, std::vector<build_target::type_template::binary_field>&) -> void;
+        auto parse_implicitly_typed_value(const kdl::build_target::type_field& field, const kdl::build_target::type_field_value& field_value, std::vector<build_target::type_template::binary_field>&) -> void;
     };
 
 }
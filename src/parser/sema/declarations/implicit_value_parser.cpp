@@ -31,8 +31,8 @@
 
 kdl::sema::implicit_value_parser::implicit_value_parser(kdl::sema::parser &parser,
                                                         std::weak_ptr<target> target,
-                                                        kdl::build_target::type_field &field,
-                                                        kdl::build_target::type_field_value &field_value,
+                                                        const kdl::build_target::type_field &field,
+                                                        const kdl::build_target::type_field_value &field_value,
                                                         kdl::build_target::type_template::binary_field binary_field)
     : m_parser(parser), m_field(field), m_field_value(field_value), m_binary_field(std::move(binary_field))
 {
@@ -28,8 +28,8 @@ namespace kdl::sema
     class implicit_value_parser
     {
     public:
-        implicit_value_parser(parser& parser, std::weak_ptr<target> target, build_target::type_field& field,
-                              build_target::type_field_value& field_value,
+        implicit_value_parser(parser& parser, std::weak_ptr<target> target, const build_target::type_field& field,
+                              const build_target::type_field_value& field_value,
                               build_target::type_template::binary_field binary_field);
 
         auto parse(build_target::resource_constructor& instance) -> void;
@@ -37,8 +37,8 @@ namespace kdl::sema
     private:
         parser& m_parser;
         std::shared_ptr<target> m_target;
-        build_target::type_field& m_field;
-        build_target::type_field_value& m_field_value;
+        const build_target::type_field& m_field;
+        const build_target::type_field_value& m_field_value;
         build_target::type_template::binary_field m_binary_field;
     };
 
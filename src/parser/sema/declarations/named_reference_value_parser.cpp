@@ -18,6 +18,7 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <optional>
 #include <stdexcept>
 #include <utility>
 #include "diagnostic/fatal.hpp"
@@ -27,8 +28,8 @@
 // MARK: - Constructor
 
 kdl::sema::named_reference_value_parser::named_reference_value_parser(kdl::sema::parser &parser,
-                                                                      build_target::type_field& field,
-                                                                      build_target::type_field_value& field_value,
+                                                                      const build_target::type_field& field,
+                                                                      const build_target::type_field_value& field_value,
                                                                       build_target::type_template::binary_field binary_field,
                                                                       kdl::build_target::kdl_type &type,
                                                                       std::weak_ptr<target> target)
@@ -56,12 +57,13 @@ auto kdl::sema::named_reference_value_parser::parse(kdl::build_target::resource_
     }
 
     auto ref = m_parser.peek();
+    std::optional<std::string> automatic_reference;
 
     if (ref.is(lexeme::identifier, "new")) {
         if (!m_field_value.explicit_type().has_value() && !m_field_value.explicit_type()->name().has_value()) {
             throw std::logic_error("Reached a nested resource with no explicitly named reference type.");
         }
-        auto type_container = target->type_container_named(m_field_value.explicit_type()->name().value());
+        const auto& type_container = target->type_container_named(m_field_value.explicit_type()->name().value());
 
         kdl::sema::resource_instance_parser instance_parser(m_parser, type_container, target);
         instance_parser.set_keyword("new");
@@ -69,6 +71,9 @@ auto kdl::sema::named_reference_value_parser::parse(kdl::build_target::resource_
 
         // Replace the nesting with an ID.
         ref = lexeme(std::to_string(nested_instance.id()), lexeme::res_id);
+        if (nested_instance.has_automatic_id()) {
+            automatic_reference = nested_instance.type_code();
+        }
     }
     else if (ref.is(lexeme::identifier)) {
         m_parser.advance();
@@ -121,4 +126,9 @@ auto kdl::sema::named_reference_value_parser::parse(kdl::build_target::resource_
             log::fatal_error(m_field.name(), 1, "Resource reference value should be backed by either a DWRD, DLNG or DQAD");
         }
     }
+
+    // The nested resource may be given a different id when it is linked, and so the reference must be tracked.
+    if (automatic_reference.has_value()) {
+        instance.mark_automatic_reference(m_field, m_field_value, automatic_reference.value());
+    }
 }
\ No newline at end of file
@@ -25,8 +25,8 @@
 
 // MARK: - Constructor
 
-kdl::sema::bitmask_parser::bitmask_parser(kdl::sema::parser &parser, kdl::build_target::type_field &field,
-                                          kdl::build_target::type_field_value &field_value,
+kdl::sema::bitmask_parser::bitmask_parser(kdl::sema::parser &parser, const kdl::build_target::type_field &field,
+                                          const kdl::build_target::type_field_value &field_value,
                                           std::vector<kdl::build_target::type_template::binary_field> binary_fields,
                                           kdl::build_target::kdl_type &type)
     : m_parser(parser),
@@ -28,8 +28,8 @@ namespace kdl::sema
     class color_parser
     {
     public:
-        color_parser(parser& parser, build_target::type_field& field,
-                     build_target::type_field_value& field_value,
+        color_parser(parser& parser, const build_target::type_field& field,
+                     const build_target::type_field_value& field_value,
                      build_target::type_template::binary_field binary_field,
                      build_target::kdl_type& type);
 
@@ -38,8 +38,8 @@ namespace kdl::sema
     private:
         parser& m_parser;
         build_target::kdl_type& m_explicit_type;
-        build_target::type_field& m_field;
-        build_target::type_field_value& m_field_value;
+        const build_target::type_field& m_field;
+        const build_target::type_field_value& m_field_value;
         build_target::type_template::binary_field m_binary_field;
     };
 
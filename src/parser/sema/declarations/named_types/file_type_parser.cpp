@@ -18,6 +18,7 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <functional>
 #include <utility>
 #include <iterator>
 #include <iostream>
@@ -26,11 +27,12 @@
 #include "media/conversion.hpp"
 #include "media/sprite_sheet_assembler.hpp"
 #include "parser/file.hpp"
+#include "target/new/assembly_cache.hpp"
 
 // MARK: - Constructor
 
-kdl::sema::file_type_parser::file_type_parser(kdl::sema::parser &parser, kdl::build_target::type_field &field,
-                                              kdl::build_target::type_field_value &field_value,
+kdl::sema::file_type_parser::file_type_parser(kdl::sema::parser &parser, const kdl::build_target::type_field &field,
+                                              const kdl::build_target::type_field_value &field_value,
                                               kdl::build_target::type_template::binary_field binary_field,
                                               kdl::build_target::kdl_type &type,
                                               std::weak_ptr<kdl::target> target)
@@ -90,7 +92,9 @@ auto kdl::sema::file_type_parser::parse(kdl::build_target::resource_constructor
                     log::fatal_error(string_lx, 1, "Could not import file contents: " + p);
                 }
 
-                content_value = kdl::file(p).vector();
+                kdl::file imported_file(p);
+                auto imported_contents = imported_file.view();
+                content_value.assign(imported_contents.begin(), imported_contents.end());
                 file_lx.emplace_back(lexeme(p, lexeme::string));
                 file_contents.emplace_back(content_value);
             }
@@ -108,7 +112,11 @@ auto kdl::sema::file_type_parser::parse(kdl::build_target::resource_constructor
     auto string_lx = file_lx.back();
     auto content_value = file_contents.back();
 
-    // Check if we need to perform a conversion on the file data.
+    // Check if we need to perform a conversion on the file data. The conversion itself is only described here,
+    // and is performed when the data is actually needed.
+    std::function<auto() -> graphite::data::block> produce;
+    std::string description;
+
     if (m_field_value.has_conversion_defined()) {
         // Get the defined input format.
         std::vector<lexeme> valid_input_formats;
@@ -126,26 +134,50 @@ auto kdl::sema::file_type_parser::parse(kdl::build_target::resource_constructor
             log::fatal_error(m_field_value.conversion_input(), 1, "Bad conversion map. Unable to deduce input format.");
         }
 
-        // Perform the conversion
         auto input_format = valid_input_formats.at(0);
         auto output_format = m_field_value.conversion_output();
 
-        if (file_contents.size() != 1) {
-            auto conversion = kdl::media::conversion(input_format, output_format);
-            for (const auto& f : file_contents) {
-                conversion.add_input_data(f);
+        description = "conversion " + input_format.text() + " -> " + output_format.text()
+                    + " of " + std::to_string(file_contents.size()) + " file(s)";
+        produce = [file_contents, input_format, output_format] {
+            if (file_contents.size() != 1) {
+                auto conversion = kdl::media::conversion(input_format, output_format);
+                for (const auto& f : file_contents) {
+                    conversion.add_input_data(f);
+                }
+                return conversion.perform_conversion();
             }
-            content_value = std::move(conversion.perform_conversion());
-        }
-        else {
-            content_value = kdl::media::conversion(content_value, input_format, output_format).perform_conversion();
-        }
+            return kdl::media::conversion(file_contents.back(), input_format, output_format).perform_conversion();
+        };
     }
 
     // Check if we're assembling a sprite sheet (this involves taking multiple input files and putting them
     // into a single image and export it as TGA data)
     else if (m_field_value.assemble_sprite_sheet()) {
-        content_value = kdl::media::sprite_sheet_assembler(file_contents, m_explicit_type.type_hints()[0]).assemble();
+        auto input_format = m_explicit_type.type_hints()[0];
+
+        description = "sprite sheet " + input_format.text() + " of " + std::to_string(file_contents.size()) + " file(s)";
+        produce = [file_contents, input_format] {
+            return kdl::media::sprite_sheet_assembler(file_contents, input_format).assemble();
+        };
+    }
+
+    if (produce) {
+        // Raw data fields can leave the work to the assembly stage. Every other field type needs to check the size of
+        // the converted data now.
+        if ((m_binary_field.type & ~0xFFFUL) == build_target::HEXD) {
+            build_target::content_digest fingerprint;
+            fingerprint.update(description);
+            for (const auto& contents : file_contents) {
+                fingerprint.update(block_to_string(contents));
+            }
+
+            instance.write_data(m_field, m_field_value, std::make_shared<const build_target::deferred_data>(
+                build_target::deferred_data { description, produce, fingerprint.hex() }
+            ));
+            return;
+        }
+        content_value = produce();
     }
 
     // Get the value type for the field, and the set it.
@@ -27,8 +27,8 @@
 
 // MARK: - Constructor
 
-kdl::sema::range_parser::range_parser(kdl::sema::parser &parser, kdl::build_target::type_field &field,
-                                      kdl::build_target::type_field_value &field_value,
+kdl::sema::range_parser::range_parser(kdl::sema::parser &parser, const kdl::build_target::type_field &field,
+                                      const kdl::build_target::type_field_value &field_value,
                                       kdl::build_target::type_template::binary_field binary_field,
                                       kdl::build_target::kdl_type &type,
                                       std::weak_ptr<kdl::target> target)
@@ -29,7 +29,7 @@
 // MARK: - Constructor
 
 kdl::sema::resource_instance_parser::resource_instance_parser(kdl::sema::parser &parser,
-                                                              kdl::build_target::type_container &type,
+                                                              const kdl::build_target::type_container &type,
                                                               std::weak_ptr<target> target,
                                                               bool discards)
     : m_type(type), m_parser(parser), m_target(std::move(target)), m_discards(discards)
@@ -81,16 +81,12 @@ auto kdl::sema::resource_instance_parser::parse() -> kdl::build_target::resource
     // Setup a source id that can be used for duplication.
     auto source_id = INT64_MIN;
 
-    if (m_keyword == "duplicate" && m_parser.expect({ expectation(lexeme::l_paren).be_true() })) {
+    if (m_keyword == "duplicate" && m_parser.expect(match(lexeme::l_paren))) {
         // The duplicate syntax is slightly unique and specific, and not just a simple list of values that can
         // be parsed.
         m_parser.advance();
 
-        if (m_parser.expect({
-            expectation(lexeme::res_id).be_true(),
-            expectation(lexeme::identifier, "as").be_true(),
-            expectation(lexeme::res_id).be_true()
-        })) {
+        if (m_parser.expect(sequence(match(lexeme::res_id), match(lexeme::identifier, keyword::as), match(lexeme::res_id)))) {
             source_id = m_parser.read().value<int64_t>();
             m_parser.advance();
             m_id = m_parser.read().value<int64_t>();
@@ -101,25 +97,25 @@ auto kdl::sema::resource_instance_parser::parse() -> kdl::build_target::resource
 
         // We may have subsequent items here so we need to parse them out... check for a comma to see if further
         // items exist or not.
-        if (m_parser.expect({ expectation(lexeme::comma).be_true() })) {
+        if (m_parser.expect(match(lexeme::comma))) {
             m_parser.read();
 
-            while (m_parser.expect({ expectation(lexeme::r_paren).be_false() })) {
+            while (m_parser.expect(!match(lexeme::r_paren))) {
                 const auto &token = m_parser.read();
 
                 if (token.is(lexeme::string)) {
                     m_name = token.text();
                 }
 
-                if (m_parser.expect({expectation(lexeme::r_paren).be_false()})) {
-                    m_parser.ensure({expectation(lexeme::comma).be_true()});
+                if (m_parser.expect(!match(lexeme::r_paren))) {
+                    m_parser.ensure(match(lexeme::comma));
                 }
             }
         }
 
-        m_parser.ensure({ expectation(lexeme::r_paren).be_true() });
+        m_parser.ensure(match(lexeme::r_paren));
     }
-    else if (m_parser.expect({ expectation(lexeme::l_paren).be_true() })) {
+    else if (m_parser.expect(match(lexeme::l_paren))) {
         list_parser list(m_parser, m_target);
 
         list.set_list_start(lexeme::l_paren);
@@ -146,11 +142,13 @@ auto kdl::sema::resource_instance_parser::parse() -> kdl::build_target::resource
     }
 
     // If the ID of the resource is INT64_MIN, then we should automatically lookup a new resource id.
-    if (m_id == INT64_MIN) {
+    auto automatic_id = (m_id == INT64_MIN);
+    if (automatic_id) {
         m_id = target->resource_tracker()->next_available_id(m_type.code());
     }
 
     auto instance = std::move(m_type.new_instance(target, m_id, m_name));
+    instance.set_automatic_id(automatic_id);
 
     // Is this resource one that is overriding another? If it is then we need to pre-populate the resource with the data
     // of the original (if it exists.)
@@ -168,26 +166,33 @@ auto kdl::sema::resource_instance_parser::parse() -> kdl::build_target::resource
             log::fatal_error(first_lx, 1, "Unable to "+ m_keyword + " resource '" + m_type.code() + "' #" + std::to_string(source_id));
         }
     }
+    else if (auto prototype = m_type.default_prototype()) {
+        // The default values of the type have already been applied to a prototype, so just copy them.
+        instance.copy_values(*prototype);
+    }
     else {
         // Acquire a new instance of the resource and populate it with default values.
         for (const auto& field : m_type.all_fields()) {
             field_parser(m_parser, m_type, instance, m_target).apply_defaults_for_field(field);
         }
         m_parser.clear_pushed_lexemes();
+
+        // Keep the defaults so that further resources of the type do not need to parse them again.
+        m_type.set_default_prototype(instance);
     }
     instance.reset_acquisition_locks();
 
-    m_parser.ensure({ expectation(lexeme::l_brace).be_true() });
-    while (m_parser.expect({ expectation(lexeme::r_brace).be_false() })) {
+    m_parser.ensure(match(lexeme::l_brace));
+    while (m_parser.expect(!match(lexeme::r_brace))) {
         field_parser(m_parser, m_type, instance, m_target).parse();
-        m_parser.ensure({ expectation(lexeme::semi).be_true() });
+        m_parser.ensure(match(lexeme::semi));
     }
-    m_parser.ensure({ expectation(lexeme::r_brace).be_true() });
+    m_parser.ensure(match(lexeme::r_brace));
 
     // Before we can hand the instance back to the caller, we need to run any assertions on it to ensure it's
     // validity.
     for (const auto& assertion : m_type.assertions()) {
-        if (!assertion.evaluate(instance.synthesize_variables())) {
+        if (!assertion.evaluate(instance)) {
             log::fatal_error(first_lx, 1, "Assertion Failed: " + assertion.failure_text());
         }
     }
@@ -198,7 +203,7 @@ auto kdl::sema::resource_instance_parser::parse() -> kdl::build_target::resource
     }
 
     // Add the resource to the target now.
-    target->add_resource(instance);
+    target->add_resource(instance, first_lx);
 
     return instance;
 }
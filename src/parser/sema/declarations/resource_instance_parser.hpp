@@ -28,7 +28,7 @@ namespace kdl::sema
     class resource_instance_parser
     {
     public:
-        resource_instance_parser(parser& parser, build_target::type_container& type, std::weak_ptr<target> target, bool discards = false);
+        resource_instance_parser(parser& parser, const build_target::type_container& type, std::weak_ptr<target> target, bool discards = false);
 
         auto set_keyword(const std::string& keyword) -> void;
         auto set_id(const int64_t& id) -> void;
@@ -42,7 +42,7 @@ namespace kdl::sema
         parser& m_parser;
         int64_t m_id { INT64_MIN };
         std::optional<std::string> m_name;
-        build_target::type_container& m_type;
+        const build_target::type_container& m_type;
         std::string m_keyword { "new" };
         std::weak_ptr<target> m_target;
         std::map<std::string, std::string> m_attributes {};
@@ -30,8 +30,8 @@
 
 kdl::sema::unnamed_reference_value_parser::unnamed_reference_value_parser(kdl::sema::parser &parser,
                                                                           std::weak_ptr<target> target,
-                                                                          build_target::type_field& field,
-                                                                          build_target::type_field_value& field_value,
+                                                                          const build_target::type_field& field,
+                                                                          const build_target::type_field_value& field_value,
                                                                           build_target::type_template::binary_field binary_field,
                                                                           kdl::build_target::kdl_type &type)
     : m_parser(parser), m_explicit_type(type), m_field(field), m_binary_field(std::move(binary_field)), m_field_value(field_value)
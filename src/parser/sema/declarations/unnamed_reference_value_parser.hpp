@@ -30,8 +30,8 @@ namespace kdl::sema
     public:
         unnamed_reference_value_parser(parser& parser,
                                        std::weak_ptr<target> target,
-                                       build_target::type_field& field,
-                                       build_target::type_field_value& field_value,
+                                       const build_target::type_field& field,
+                                       const build_target::type_field_value& field_value,
                                        build_target::type_template::binary_field binary_field,
                                        build_target::kdl_type& type);
 
@@ -41,8 +41,8 @@ namespace kdl::sema
         parser& m_parser;
         std::shared_ptr<target> m_target;
         build_target::kdl_type& m_explicit_type;
-        build_target::type_field& m_field;
-        build_target::type_field_value& m_field_value;
+        const build_target::type_field& m_field;
+        const build_target::type_field_value& m_field_value;
         build_target::type_template::binary_field m_binary_field;
     };
 
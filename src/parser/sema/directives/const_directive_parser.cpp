@@ -24,7 +24,7 @@
 #include "parser/sema/directives/const_directive_parser.hpp"
 #include "target/new/kdl_expression.hpp"
 
-auto kdl::sema::const_directive_parser::parse(parser &parser, std::weak_ptr<target> target) -> void
+auto kdl::sema::const_directive_parser::parse(parser &parser, std::weak_ptr<target> target, bool is_mutable) -> void
 {
     if (target.expired()) {
         throw std::logic_error("Build target has expired. This is a bug!");
@@ -44,6 +44,11 @@ auto kdl::sema::const_directive_parser::parse(parser &parser, std::weak_ptr<targ
         expression_lexemes.emplace_back(parser.read());
     }
     auto expression = std::make_shared<build_target::kdl_expression>(expression_lexemes);
-    auto value = expression->evaluate(t);
-    t->set_global_variable(var_name.text(), value);
+    auto value = expression->call(t, nullptr, 0);
+
+    // Expressions that depend on mutable variables can not be treated as pure.
+    if (is_mutable) {
+        t->set_global_variable_mutable(var_name.text());
+    }
+    t->set_global_variable(var_name.symbol(), value);
 }
@@ -27,6 +27,6 @@ namespace kdl::sema
     class const_directive_parser
     {
     public:
-        static auto parse(parser& parser, std::weak_ptr<target> target) -> void;
+        static auto parse(parser& parser, std::weak_ptr<target> target, bool is_mutable = false) -> void;
     };
 }
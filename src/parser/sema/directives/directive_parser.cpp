@@ -29,6 +29,7 @@
 #include "parser/sema/directives/version_directive_parser.hpp"
 #include "parser/sema/directives/const_directive_parser.hpp"
 #include "parser/sema/directives/function_directive_parser.hpp"
+#include "parser/sema/directives/pragma_directive_parser.hpp"
 
 // MARK: - Constructor
 
@@ -72,12 +73,15 @@ auto kdl::sema::asm_directive::parse() -> void
         const_directive_parser::parse(m_parser, m_target);
     }
     else if (directive.text() == "var") {
-        // TODO: Make a mutable version of the parser, and make const actually constant.
-        const_directive_parser::parse(m_parser, m_target);
+        // TODO: Make const actually constant.
+        const_directive_parser::parse(m_parser, m_target, true);
     }
     else if (directive.text() == "function") {
         function_directive_parser::parse(m_parser, m_target);
     }
+    else if (directive.text() == "pragma") {
+        pragma_directive_parser::parse(m_parser, m_target);
+    }
     else {
         log::fatal_error(directive, 1, "Unrecognised directive '" + directive.text() + "'");
     }
@@ -43,5 +43,8 @@ auto kdl::sema::function_directive_parser::parse(parser &parser, std::weak_ptr<t
         expression_lexemes.emplace_back(parser.read());
     }
     auto expression = std::make_shared<build_target::kdl_expression>(expression_lexemes);
+
+    // Functions that always produce the same result are only evaluated once, when they are first called.
+    expression->allow_folding();
     t->set_function_expression(function_name.text(), expression);
 }
\ No newline at end of file
@@ -22,11 +22,37 @@
 #include "diagnostic/fatal.hpp"
 #include "parser/lexer.hpp"
 #include "parser/sema/directives/import_directive_parser.hpp"
+#include "target/new/type_module.hpp"
 
+#include "libraries/precompiled_libraries.hpp"
 #include "libraries/macintosh/macintosh_library.hpp"
 #include "libraries/spriteworld/spriteworld_library.hpp"
 #include "libraries/kestrel/kestrel_library.hpp"
 
+// MARK: - Built-in Libraries
+
+namespace
+{
+    /**
+     * Add the types of a built-in library to the target from its embedded type module. Returns false if there is no
+     * embedded module for the library, in which case the source of the library needs to be imported instead.
+     */
+    auto import_precompiled_library(const std::shared_ptr<kdl::target>& target, const std::string& name, const kdl::lexeme& reference) -> bool
+    {
+        auto data = kdl::builtin::libraries::precompiled_module(name);
+        if (data.empty()) {
+            return false;
+        }
+
+        auto file = std::make_shared<kdl::file>(name + kdl::build_target::type_module::extension, std::string(data));
+        auto module = kdl::build_target::type_module::read(file, reference);
+        for (const auto& container : module.type_containers()) {
+            target->add_type_container(container);
+        }
+        return true;
+    }
+}
+
 // MARK: - Parser
 
 auto kdl::sema::import_directive_parser::parse(parser &parser, std::weak_ptr<target> target) -> void
@@ -37,38 +63,68 @@ auto kdl::sema::import_directive_parser::parse(parser &parser, std::weak_ptr<tar
     auto t = target.lock();
 
     if (parser.expect({ expectation(lexeme::identifier, "Macintosh").be_true() })) {
-        // TODO: Track duplicate imports and prevent them.
-        parser.advance();
-        kdl::builtin::libraries::macintosh::import(parser);
+        auto library = parser.read();
+        if (t->should_import("Macintosh") && !import_precompiled_library(t, "Macintosh", library)) {
+            kdl::builtin::libraries::macintosh::import(parser);
+        }
     }
     else if (parser.expect({ expectation(lexeme::identifier, "SpriteWorld").be_true() })) {
-        // TODO: Track duplicate imports and prevent them.
-        parser.advance();
-        kdl::builtin::libraries::spriteworld::import(parser);
+        auto library = parser.read();
+        if (t->should_import("SpriteWorld") && !import_precompiled_library(t, "SpriteWorld", library)) {
+            kdl::builtin::libraries::spriteworld::import(parser);
+        }
     }
     else if (parser.expect({ expectation(lexeme::identifier, "Kestrel").be_true() })) {
-        // TODO: Track duplicate imports and prevent them.
-        parser.advance();
-        kdl::builtin::libraries::kestrel::import(parser);
+        auto library = parser.read();
+        if (t->should_import("Kestrel") && !import_precompiled_library(t, "Kestrel", library)) {
+            kdl::builtin::libraries::kestrel::import(parser);
+        }
     }
     else if (parser.expect({ expectation(lexeme::string).be_true() })) {
         auto include_path = parser.read();
 
-        // Resolve the path/file to be included.
+        // Resolve the path/file to be included. Each file is only imported once, unless it has opted in to being
+        // imported multiple times.
         auto resolved_include_path = t->resolve_src_path(include_path);
+        auto import_key = kdl::target::canonical_import_path(resolved_include_path);
+        if (!t->should_import(import_key)) {
+            return;
+        }
 
-        // Open the file and prepare to perform lexical analysis.
-        auto file = std::make_shared<kdl::file>(resolved_include_path);
-        if (!file->exists()) {
-            log::fatal_error(include_path, 1, "Could not open file: " + resolved_include_path);
+        // Precompiled type modules contain type definitions that have already been parsed, so they can be added to
+        // the target directly, without going through the lexer and parser again.
+        if (build_target::type_module::is_module_path(resolved_include_path)) {
+            auto file = std::make_shared<kdl::file>(resolved_include_path);
+            if (!file->exists()) {
+                log::fatal_error(include_path, 1, "Could not open type module: " + resolved_include_path);
+            }
+
+            t->track_imported_file(file);
+            auto module = build_target::type_module::read(file, include_path);
+            for (const auto& container : module.type_containers()) {
+                t->add_type_container(container);
+            }
+            return;
         }
-        auto lexer = kdl::lexer(file);
 
-        // Perform lexical analysis and insert the lexemes into the parser. As we're still expecting a semi colon to appear,
-        // we need to insert the lexemes _after_ it.
-        t->track_imported_file(file);
-        parser.insert(lexer.analyze(), 1);
+        // If the file has already been lexed, then reuse the result of that.
+        auto lexemes = t->cached_import(import_key);
+        if (!lexemes) {
+            // Open the file and prepare to perform lexical analysis.
+            auto file = std::make_shared<kdl::file>(resolved_include_path);
+            if (!file->exists()) {
+                log::fatal_error(include_path, 1, "Could not open file: " + resolved_include_path);
+            }
+            auto lexer = kdl::lexer(file);
+
+            t->track_imported_file(file);
+            lexemes = std::make_shared<const std::vector<lexeme>>(lexer.analyze());
+            t->cache_import(import_key, lexemes);
+        }
 
+        // Insert the lexemes into the parser. As we're still expecting a semi colon to appear, we need to insert the
+        // lexemes _after_ it.
+        parser.insert(lexemes, 1);
     }
     else {
         log::fatal_error(parser.peek(), 1, "Expected string for include path.");
@@ -19,7 +19,7 @@
 // SOFTWARE.
 
 #include <stdexcept>
-#include <iostream>
+#include <ostream>
 #include "diagnostic/fatal.hpp"
 #include "parser/sema/directives/out_directive_parser.hpp"
 #include "parser/sema/expression/expression_parser.hpp"
@@ -31,20 +31,21 @@ auto kdl::sema::out_directive_parser::parse(kdl::sema::parser &parser, std::weak
         throw std::logic_error("Build target has expired. This is a bug!");
     }
     auto t = target.lock();
+    auto& out = t->output();
 
     while (parser.expect({ expectation(lexeme::semi).be_false() })) {
         if (parser.expect({ expectation(lexeme::l_expr).be_true() })) {
             auto expr = expression_parser::extract(parser);
             auto value = expr->evaluate(t);
-            std::cout << value.text();
+            out << value.text();
         }
         else if (parser.expect({ expectation(lexeme::var).be_true() })) {
             auto value = variable_parser::parse(parser, t);
-            std::cout << value.text();
+            out << value.text();
         }
         else {
-            std::cout << parser.read().text();
+            out << parser.read().text();
         }
     }
-    std::cout << std::endl;
+    out << std::endl;
 }
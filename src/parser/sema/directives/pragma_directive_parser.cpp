@@ -0,0 +1,64 @@
+// Copyright (c) 2022 Tom Hancocks
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <stdexcept>
+#include "diagnostic/fatal.hpp"
+#include "parser/sema/directives/pragma_directive_parser.hpp"
+
+auto kdl::sema::pragma_directive_parser::parse(kdl::sema::parser &parser, std::weak_ptr<target> target) -> void
+{
+    if (target.expired()) {
+        throw std::logic_error("Build target has expired. This is a bug!");
+    }
+    auto t = target.lock();
+
+    if (!parser.expect({ expectation(lexeme::identifier).be_true() })) {
+        log::fatal_error(parser.peek(), 1, "Expected identifier for pragma.");
+    }
+    auto pragma = parser.read();
+
+    if (pragma.is("multiple_import")) {
+        // The file containing the pragma may be imported more than once. Files are otherwise only imported once.
+        if (auto file = pragma.owner()) {
+            t->allow_multiple_imports(kdl::target::canonical_import_path(file->path()));
+        }
+    }
+    else if (pragma.is("fill_id_gaps")) {
+        // Resources declared with #auto are allocated the lowest unused id, rather than the id following the highest.
+        t->set_id_allocation_policy(resource_tracking::table::allocation_policy::fill_gaps);
+    }
+    else if (pragma.is("reserve_ids")) {
+        // Reserve a range of ids for a type, so that they are never allocated to resources declared with #auto.
+        if (!parser.expect({ expectation(lexeme::identifier).be_true() })) {
+            log::fatal_error(parser.peek(), 1, "Expected a type name for the reserved ids.");
+        }
+        const auto& type = t->type_container_named(parser.read());
+
+        if (!parser.expect({ expectation(lexeme::res_id).be_true(), expectation(lexeme::res_id).be_true() })) {
+            log::fatal_error(parser.peek(), 1, "Expected the first and last resource id of the reserved range.");
+        }
+        auto first = parser.read().value<int64_t>();
+        auto last = parser.read().value<int64_t>();
+        t->reserve_resource_ids(type.code(), first, last);
+    }
+    else {
+        log::fatal_error(pragma, 1, "Unrecognised pragma '" + pragma.text() + "'");
+    }
+}
@@ -0,0 +1,260 @@
+// Copyright (c) 2022 Tom Hancocks
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <stdexcept>
+#include "parser/sema/expression/expression_compiler.hpp"
+#include "diagnostic/fatal.hpp"
+
+// MARK: - Helpers
+
+namespace
+{
+    using kdl::lexeme;
+    using kdl::build_target::kdl_bytecode;
+
+    struct cursor
+    {
+        const std::vector<lexeme>& lexemes;
+        std::size_t position { 0 };
+
+        [[nodiscard]] auto finished() const -> bool
+        {
+            return position >= lexemes.size();
+        }
+
+        [[nodiscard]] auto expect(enum lexeme::type type, std::size_t offset = 0) const -> bool
+        {
+            return (position + offset) < lexemes.size() && lexemes[position + offset].is(type);
+        }
+
+        [[nodiscard]] auto peek() const -> lexeme
+        {
+            if (finished()) {
+                if (lexemes.empty()) {
+                    throw std::logic_error("[kdl::sema::expression_compiler] Attempted to access lexeme beyond end of expression.");
+                }
+                kdl::log::fatal_error(lexemes.back(), 1, "Unexpected end of expression.");
+            }
+            return lexemes[position];
+        }
+
+        auto read() -> lexeme
+        {
+            auto lx = peek();
+            position++;
+            return lx;
+        }
+
+        auto ensure(enum lexeme::type type) -> void
+        {
+            auto lx = read();
+            if (!lx.is(type)) {
+                kdl::log::fatal_error(lx, 1, "Could not ensure the correctness of the token '" + lx.text() + "'");
+            }
+        }
+    };
+
+    auto is_operator(const lexeme& lx) -> bool
+    {
+        switch (lx.type()) {
+            case lexeme::plus:
+            case lexeme::minus:
+            case lexeme::star:
+            case lexeme::slash:
+            case lexeme::carat:
+            case lexeme::amp:
+            case lexeme::pipe:
+            case lexeme::tilde:
+            case lexeme::left_shift:
+            case lexeme::right_shift:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    auto precedence(const lexeme& op) -> std::int64_t
+    {
+        // The unary complement binds more tightly than any of the binary operators.
+        return op.is(lexeme::tilde) ? 8 : op.value<std::int64_t>();
+    }
+
+    auto compile_call(cursor& in, kdl_bytecode& code) -> void;
+
+    auto compile_single(const lexeme& lx) -> kdl_bytecode
+    {
+        kdl_bytecode code;
+        code.set_single_value(true);
+        code.set_origin(lx);
+
+        if (lx.is(lexeme::string) || lx.is(lexeme::integer) || lx.is(lexeme::percentage) || lx.is(lexeme::res_id)) {
+            code.push_constant(lx);
+        }
+        else if (lx.is(lexeme::var) || lx.is(lexeme::identifier)) {
+            code.load_variable(lx);
+        }
+        else {
+            kdl::log::fatal_error(lx, 1, "Invalid lexeme encountered in expression.");
+        }
+
+        return code;
+    }
+
+    auto compile_arithmetic(cursor& in, bool argument, kdl_bytecode& code) -> void
+    {
+        std::vector<lexeme> operators;
+
+        while (!in.finished()) {
+            // Arguments run up to the next comma or closing parenthesis, whichever comes first.
+            if (argument && (in.expect(lexeme::comma) || in.expect(lexeme::r_paren))) {
+                break;
+            }
+
+            if (in.expect(lexeme::identifier) && in.expect(lexeme::l_paren, 1)) {
+                compile_call(in, code);
+                continue;
+            }
+            else if (in.expect(lexeme::var) || in.expect(lexeme::identifier)) {
+                code.load_variable(in.read());
+                continue;
+            }
+
+            auto token = in.read();
+            if (token.is(lexeme::integer) || token.is(lexeme::res_id) || token.is(lexeme::percentage)) {
+                code.push_constant(token);
+            }
+            else if (is_operator(token)) {
+                while (!operators.empty()) {
+                    const auto& o2 = operators.back();
+                    if (!o2.is(lexeme::l_paren) && precedence(o2) >= precedence(token) && token.left_associative()) {
+                        code.apply_operator(o2);
+                        operators.pop_back();
+                    }
+                    else {
+                        break;
+                    }
+                }
+                operators.emplace_back(token);
+            }
+            else if (token.is(lexeme::l_paren)) {
+                operators.emplace_back(token);
+            }
+            else if (token.is(lexeme::r_paren)) {
+                while (!operators.empty() && !operators.back().is(lexeme::l_paren)) {
+                    code.apply_operator(operators.back());
+                    operators.pop_back();
+                }
+
+                if (operators.empty()) {
+                    kdl::log::fatal_error(token, 1, "Expected a '(' token.");
+                }
+
+                operators.pop_back();
+            }
+        }
+
+        // Any unbalanced opening parenthesis is ignored, as it is by the reference evaluator.
+        while (!operators.empty()) {
+            if (!operators.back().is(lexeme::l_paren)) {
+                code.apply_operator(operators.back());
+            }
+            operators.pop_back();
+        }
+    }
+
+    auto compile_argument(cursor& in) -> kdl_bytecode
+    {
+        kdl_bytecode argument;
+        argument.set_origin(in.peek());
+
+        if (in.expect(lexeme::identifier) && in.expect(lexeme::l_paren, 1)) {
+            argument.set_single_value(true);
+            compile_call(in, argument);
+        }
+        else if (in.expect(lexeme::var) || in.expect(lexeme::identifier)) {
+            argument.set_single_value(true);
+            argument.load_variable(in.read());
+        }
+        else {
+            auto start = in.position;
+            compile_arithmetic(in, true, argument);
+            if (in.position - start == 1) {
+                return compile_single(in.lexemes[start]);
+            }
+        }
+
+        return argument;
+    }
+
+    auto compile_call(cursor& in, kdl_bytecode& code) -> void
+    {
+        auto name = in.read();
+        in.ensure(lexeme::l_paren);
+
+        if (auto builtin = kdl_bytecode::builtin_named(name.text())) {
+            // We now _require_ a variable to be specified.
+            if (!in.expect(lexeme::var)) {
+                kdl::log::fatal_error(in.peek(), 1, "The built-in function '" + name.text() + "' requires a variable name argument.");
+            }
+            code.call_builtin(builtin.value(), name, in.read());
+            in.ensure(lexeme::r_paren);
+            return;
+        }
+
+        std::vector<kdl_bytecode> arguments;
+        while (!in.finished() && !in.expect(lexeme::r_paren)) {
+            arguments.emplace_back(compile_argument(in));
+
+            if (in.expect(lexeme::comma)) {
+                in.read();
+                continue;
+            }
+            else if (in.expect(lexeme::r_paren)) {
+                break;
+            }
+            else {
+                kdl::log::fatal_error(in.peek(), 1, "Unexpected lexeme encountered in expression. Expected ',' or ')'.");
+            }
+        }
+
+        in.ensure(lexeme::r_paren);
+        code.call_function(name, std::move(arguments));
+    }
+}
+
+// MARK: - Compilation
+
+auto kdl::sema::expression_compiler::compile(const std::vector<lexeme> &lexemes) -> build_target::kdl_bytecode
+{
+    // Single values are returned verbatim, rather than being evaluated arithmetically.
+    if (lexemes.size() == 1) {
+        return compile_single(lexemes.front());
+    }
+
+    build_target::kdl_bytecode code;
+    if (!lexemes.empty()) {
+        code.set_origin(lexemes.front());
+    }
+
+    cursor in { lexemes };
+    compile_arithmetic(in, false, code);
+    return code;
+}
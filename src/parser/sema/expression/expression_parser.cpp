@@ -99,7 +99,7 @@ auto kdl::sema::expression_parser::evaluate(parser &parser, std::shared_ptr<targ
             sema::expectation(lexeme::var).be_true(),
             sema::expectation(lexeme::identifier).be_true(),
         })) {
-            return variable_parser::parse(parser, target);
+            return variable_parser::parse(parser, target, local_vars);
         }
 
         log::fatal_error(parser.peek(), 1, "Invalid lexeme encountered in expression.");
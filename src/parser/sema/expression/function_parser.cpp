@@ -57,28 +57,21 @@ auto kdl::sema::function_parser::parse(parser &parser, std::shared_ptr<target> t
             log::fatal_error(value, 1, "The built-in function '" + function_name + "' requires a variable for a numeric value to be specified as an argument.");
         }
 
+        // Updated values are stored in their decoded form, and are only formatted if they are returned.
         auto v = value.value<std::int64_t>();
         if (function_name == "__postIncrement") {
-            v++;
-            auto new_value = lexeme(std::to_string(v), value.type());
-            target->set_global_variable(var_name_lx.text(), new_value);
+            target->set_global_variable(var_name_lx.symbol(), build_target::kdl_value::numeric(value.type(), v + 1));
         }
         else if (function_name == "__preIncrement") {
-            v++;
-            auto new_value = lexeme(std::to_string(v), value.type());
-            target->set_global_variable(var_name_lx.text(), new_value);
-            value = new_value;
+            target->set_global_variable(var_name_lx.symbol(), build_target::kdl_value::numeric(value.type(), v + 1));
+            value = lexeme(std::to_string(v + 1), value.type());
         }
         else if (function_name == "__postDecrement") {
-            v--;
-            auto new_value = lexeme(std::to_string(v), value.type());
-            target->set_global_variable(var_name_lx.text(), new_value);
+            target->set_global_variable(var_name_lx.symbol(), build_target::kdl_value::numeric(value.type(), v - 1));
         }
         else if (function_name == "__preDecrement") {
-            v--;
-            auto new_value = lexeme(std::to_string(v), value.type());
-            target->set_global_variable(var_name_lx.text(), new_value);
-            value = new_value;
+            target->set_global_variable(var_name_lx.symbol(), build_target::kdl_value::numeric(value.type(), v - 1));
+            value = lexeme(std::to_string(v - 1), value.type());
         }
         else if (function_name == "__integer") {
             value = lexeme(value.text(), lexeme::integer);
@@ -23,22 +23,16 @@
 
 auto kdl::sema::variable_parser::parse(parser &parser, std::shared_ptr<target> target, const std::unordered_map<std::string, kdl::lexeme> vars) -> kdl::lexeme
 {
-    std::unordered_map<std::string, lexeme> local_vars(target->all_global_variables());
-
-    for (const auto& var : vars) {
-        auto it = local_vars.find(var.first);
-        if (it == local_vars.end()) {
-            local_vars.insert(std::pair(var.first, var.second));
-        }
-        else {
-            it->second = var.second;
-        }
+    // Variables that have been supplied take precedence over globals.
+    auto var_name = parser.read();
+    auto it = vars.find(var_name.text());
+    if (it != vars.end()) {
+        return it->second;
     }
 
-    auto var_name = parser.read();
-    auto it = local_vars.find(var_name.text());
-    if (it == local_vars.end()) {
-        log::fatal_error(var_name, 1, "Unrecognised variable referenced.");
+    if (auto value = target->global_value(var_name.symbol())) {
+        return value->to_lexeme();
     }
-    return it->second;
+
+    log::fatal_error(var_name, 1, "Unrecognised variable referenced.");
 }
\ No newline at end of file
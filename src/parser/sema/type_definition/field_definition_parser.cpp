@@ -26,7 +26,7 @@
 
 // MARK: - Constructor
 
-kdl::sema::field_definition_parser::field_definition_parser(kdl::sema::parser &parser, std::weak_ptr<target> target, kdl::build_target::type_template tmpl)
+kdl::sema::field_definition_parser::field_definition_parser(kdl::sema::parser &parser, std::weak_ptr<target> target, const kdl::build_target::type_template& tmpl)
     : m_parser(parser), m_tmpl(tmpl)
 {
     if (target.expired()) {
@@ -29,14 +29,14 @@ namespace kdl::sema
     class field_definition_parser
     {
     public:
-        field_definition_parser(parser& parser, std::weak_ptr<target> target, build_target::type_template tmpl);
+        field_definition_parser(parser& parser, std::weak_ptr<target> target, const build_target::type_template& tmpl);
 
         auto parse() -> build_target::type_field;
 
     private:
         parser& m_parser;
         std::shared_ptr<target> m_target;
-        build_target::type_template m_tmpl;
+        const build_target::type_template& m_tmpl;
 
     };
 
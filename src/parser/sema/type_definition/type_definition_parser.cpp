@@ -79,6 +79,9 @@ auto kdl::sema::type_definition_parser::parse(bool directive) -> kdl::build_targ
         m_parser.ensure({ expectation(lexeme::semi).be_true() });
     }
     m_parser.ensure({ expectation(lexeme::r_brace).be_true() });
+
+    // The definition is complete, so compile it into its immutable form.
+    type.freeze();
     return type;
 }
 
@@ -28,7 +28,7 @@
 
 // MARK: - Constructor
 
-kdl::sema::value_reference_parser::value_reference_parser(kdl::sema::parser &parser, std::weak_ptr<target> target, build_target::type_template tmpl)
+kdl::sema::value_reference_parser::value_reference_parser(kdl::sema::parser &parser, std::weak_ptr<target> target, const build_target::type_template& tmpl)
     : m_parser(parser), m_tmpl(tmpl)
 {
     if (target.expired()) {
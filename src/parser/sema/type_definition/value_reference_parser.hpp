@@ -31,14 +31,14 @@ namespace kdl::sema
     class value_reference_parser
     {
     public:
-        value_reference_parser(parser& parser, std::weak_ptr<target> target, build_target::type_template tmpl);
+        value_reference_parser(parser& parser, std::weak_ptr<target> target, const build_target::type_template& tmpl);
 
         auto parse() -> build_target::type_field_value;
 
     private:
         parser& m_parser;
         std::shared_ptr<target> m_target;
-        build_target::type_template m_tmpl;
+        const build_target::type_template& m_tmpl;
 
     };
 
@@ -0,0 +1,168 @@
+// Copyright (c) 2022 Tom Hancocks
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <charconv>
+#include <stdexcept>
+#include "parser/symbol_table.hpp"
+#include "parser/keyword.hpp"
+
+// MARK: - Numeric Decoding
+
+auto kdl::symbol_table::decode_value(std::string_view text, entry& entry) -> void
+{
+    // This mirrors the decoding rules of lexeme::value<T>(). Anything that can not be cleanly decoded here is
+    // left for lexeme::value<T>() to handle (and report) at the point of use.
+    const auto *first = text.data();
+    const auto *last = text.data() + text.size();
+
+    if (text.size() >= 2 && text[0] == '-') {
+        std::int64_t value = 0;
+        if (std::from_chars(first, last, value, 10).ec == std::errc()) {
+            entry.value = static_cast<std::uint64_t>(value);
+            entry.value_is_signed = true;
+            entry.has_value = true;
+        }
+    }
+    else if (text.size() >= 3 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) {
+        std::uint64_t value = 0;
+        if (std::from_chars(first + 2, last, value, 16).ec == std::errc()) {
+            entry.value = value;
+            entry.has_value = true;
+        }
+    }
+    else if (!text.empty() && text[0] != '-') {
+        std::uint64_t value = 0;
+        if (std::from_chars(first, last, value, 10).ec == std::errc()) {
+            entry.value = value;
+            entry.has_value = true;
+        }
+    }
+}
+
+// MARK: - Construction
+
+kdl::symbol_table::symbol_table()
+{
+    // Keywords take the first symbols of the table, so that they match the constants in kdl::keyword.
+    for (const auto& name : keyword::names) {
+        create(shard_for(name), name);
+    }
+}
+
+// MARK: - Shared Table
+
+auto kdl::symbol_table::shared() -> symbol_table&
+{
+    static symbol_table table;
+    return table;
+}
+
+// MARK: - Interning
+
+auto kdl::symbol_table::intern(std::string_view text) -> symbol
+{
+    auto& shard = shard_for(text);
+    std::lock_guard<std::mutex> lock(shard.lock);
+
+    auto it = shard.symbols.find(text);
+    if (it != shard.symbols.end()) {
+        return it->second;
+    }
+
+    return create(shard, text);
+}
+
+auto kdl::symbol_table::intern(const std::vector<std::string>& components) -> symbol
+{
+    std::string text;
+    auto is_first = true;
+    for (const auto& component : components) {
+        text += (is_first ? "" : ".") + component;
+        is_first = false;
+    }
+
+    auto& shard = shard_for(text);
+    std::lock_guard<std::mutex> lock(shard.lock);
+
+    auto it = shard.symbols.find(text);
+    auto sym = (it != shard.symbols.end()) ? it->second : create(shard, text);
+
+    // Components are only ever attached to an entry once, and before any lexeme that could read them exists.
+    auto& entry = mutable_entry(sym);
+    if (!entry.has_components) {
+        entry.components = components;
+
+        if (!components.empty()) {
+            std::int64_t value = 0;
+            const auto& back = components.back();
+            if (std::from_chars(back.data(), back.data() + back.size(), value, 10).ec == std::errc()) {
+                entry.component_value = value;
+                entry.has_component_value = true;
+            }
+        }
+
+        entry.has_components = true;
+    }
+
+    return sym;
+}
+
+auto kdl::symbol_table::size() const -> std::size_t
+{
+    return m_next.load();
+}
+
+// MARK: - Storage
+
+auto kdl::symbol_table::shard_for(std::string_view text) -> shard&
+{
+    return m_shards[std::hash<std::string_view>()(text) % shard_count];
+}
+
+auto kdl::symbol_table::create(shard& shard, std::string_view text) -> symbol
+{
+    auto sym = m_next++;
+    auto segment = sym >> segment_bits;
+    if (segment >= segment_count) {
+        throw std::length_error("Symbol table exhausted.");
+    }
+
+    // Symbols are created by several shards at once, so the first symbol of a segment is not necessarily the first
+    // to need it. Whichever thread gets there first allocates the segment.
+    if (!m_segments[segment].load(std::memory_order_acquire)) {
+        auto storage = new entry[segment_size];
+        entry *expected = nullptr;
+        if (!m_segments[segment].compare_exchange_strong(expected, storage, std::memory_order_acq_rel)) {
+            delete[] storage;
+        }
+    }
+
+    auto& entry = mutable_entry(sym);
+    entry.text = std::string(text);
+    decode_value(entry.text, entry);
+
+    shard.symbols.emplace(std::string_view(entry.text), sym);
+    return sym;
+}
+
+auto kdl::symbol_table::mutable_entry(symbol sym) -> entry&
+{
+    return m_segments[sym >> segment_bits].load(std::memory_order_acquire)[sym & segment_mask];
+}
@@ -0,0 +1,118 @@
+// Copyright (c) 2022 Tom Hancocks
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace kdl
+{
+
+    /**
+     * The kdl::symbol_table stores the text of every identifier, keyword and symbol exactly once. Lexemes refer to
+     * their text by a symbol id, which keeps them small and cheap to copy. Literals from a source file are only
+     * interned if they are used as a name, and otherwise refer to their text within the source. Numeric values are decoded when a symbol is first
+     * interned, so that they do not need to be parsed each time they are requested.
+     *
+     * Symbols are never removed from the table, and the storage of a symbol never moves once it has been
+     * created. Looking up the entry of a symbol does not require a lock. Interning is safe from several threads at
+     * once: the text index is split into shards by hash, and only the shard of the text being interned is locked.
+     */
+    class symbol_table
+    {
+    public:
+        typedef std::uint32_t symbol;
+
+        struct entry
+        {
+            std::string text;
+            std::vector<std::string> components;
+            bool has_components { false };
+
+            bool has_value { false };
+            bool value_is_signed { false };
+            std::uint64_t value { 0 };
+
+            bool has_component_value { false };
+            std::int64_t component_value { 0 };
+        };
+
+    public:
+        static auto shared() -> symbol_table&;
+
+        /**
+         * Intern the specified text, returning the symbol that represents it.
+         */
+        auto intern(std::string_view text) -> symbol;
+
+        /**
+         * Intern the specified resource reference components. The text of the symbol is the components
+         * joined by a '.'.
+         */
+        auto intern(const std::vector<std::string>& components) -> symbol;
+
+        /**
+         * Look up the entry for the specified symbol.
+         */
+        [[nodiscard]] auto operator[](symbol sym) const -> const entry&
+        {
+            return m_segments[sym >> segment_bits].load(std::memory_order_acquire)[sym & segment_mask];
+        }
+
+        [[nodiscard]] auto size() const -> std::size_t;
+
+        /**
+         * Decode the numeric value of the specified text into the entry, if it has one.
+         */
+        static auto decode_value(std::string_view text, entry& entry) -> void;
+
+    private:
+        static constexpr std::size_t segment_bits = 12;
+        static constexpr std::size_t segment_size = 1 << segment_bits;
+        static constexpr std::size_t segment_mask = segment_size - 1;
+        static constexpr std::size_t segment_count = 1 << 16;
+        static constexpr std::size_t shard_count = 64;
+
+        struct shard
+        {
+            std::mutex lock;
+            std::unordered_map<std::string_view, symbol> symbols;
+        };
+
+        std::array<std::atomic<entry *>, segment_count> m_segments {};
+        std::array<shard, shard_count> m_shards;
+        std::atomic<symbol> m_next { 0 };
+
+        symbol_table();
+
+        auto shard_for(std::string_view text) -> shard&;
+        auto create(shard& shard, std::string_view text) -> symbol;
+        auto mutable_entry(symbol sym) -> entry&;
+    };
+
+};
@@ -20,6 +20,8 @@
 
 #include "diagnostic/fatal.hpp"
 #include "target/assertion.hpp"
+#include "target/new/resource.hpp"
+#include "target/new/type_template.hpp"
 
 // MARK: - Constructor
 
@@ -28,36 +30,123 @@ kdl::assertion::assertion(const lexeme& lhs, assertion::operation op, const lexe
 {
 }
 
-// MARK: - Evaluation
+kdl::assertion::operand::operand(const lexeme &lx)
+    : lx(lx)
+{
+    literal.type = lx.type();
+    if (lx.is(lexeme::integer) || lx.is(lexeme::res_id) || lx.is(lexeme::percentage)) {
+        literal.number = lx.value<__int128>();
+    }
+    literal.text = lx.text();
+}
+
+// MARK: - Accessors
+
+auto kdl::assertion::lhs() const -> lexeme
+{
+    return m_lhs.lx;
+}
+
+auto kdl::assertion::operation_type() const -> enum operation
+{
+    return m_operation;
+}
+
+auto kdl::assertion::rhs() const -> lexeme
+{
+    return m_rhs.lx;
+}
+
+// MARK: - Compilation
 
-static auto __resolve_variable(const kdl::lexeme& var, std::unordered_map<std::string, kdl::lexeme> table) -> kdl::lexeme
+auto kdl::assertion::compile(const build_target::type_template &tmpl) -> void
 {
-    if (!var.is(kdl::lexeme::var)) {
-        return var;
+    for (auto op : { &m_lhs, &m_rhs }) {
+        if (!op->lx.is(lexeme::var)) {
+            op->source = operand::source::literal;
+        }
+        else if (op->lx.is("id")) {
+            op->source = operand::source::id;
+        }
+        else if (op->lx.is("name")) {
+            op->source = operand::source::name;
+        }
+        else if (tmpl.has_binary_field_named(op->lx)) {
+            op->source = operand::source::field;
+            op->type = tmpl.binary_field_named(op->lx).type;
+        }
+        else {
+            op->source = operand::source::unknown;
+        }
     }
+    m_compiled = true;
+}
+
+// MARK: - Evaluation
 
-    if (table.find(var.text()) == table.end()) {
-        kdl::log::fatal_error(var, 1, "Unknown variable encountered in assertion '" + var.text() + "'");
+auto kdl::assertion::resolve(const operand& op, const build_target::resource_constructor& resource) -> value
+{
+    switch (op.source) {
+        case operand::source::literal: {
+            return op.literal;
+        }
+        case operand::source::id: {
+            return { lexeme::res_id, resource.id(), {} };
+        }
+        case operand::source::name: {
+            return { lexeme::string, 0, resource.name() };
+        }
+        case operand::source::field: {
+            if (auto field_value = resource.assertion_value(op.lx, op.type)) {
+                return field_value.value();
+            }
+            break;
+        }
+        case operand::source::unknown: {
+            break;
+        }
     }
 
-    return table.at(var.text());
+    kdl::log::fatal_error(op.lx, 1, "Unknown variable encountered in assertion '" + op.lx.text() + "'");
 }
 
-auto kdl::assertion::evaluate(std::unordered_map<std::string, lexeme> variables) const -> bool
+auto kdl::assertion::evaluate(const build_target::resource_constructor& resource) const -> bool
 {
-    auto lhs = __resolve_variable(m_lhs, variables);
-    auto rhs = __resolve_variable(m_rhs, variables);
+    if (!m_compiled) {
+        return evaluate(resource.synthesize_variables());
+    }
+    return compare(resolve(m_lhs, resource), resolve(m_rhs, resource));
+}
+
+auto kdl::assertion::evaluate(const std::unordered_map<std::string, lexeme>& variables) const -> bool
+{
+    const auto lookup = [&] (const operand& op) -> value {
+        if (!op.lx.is(lexeme::var)) {
+            return op.literal;
+        }
 
-    if (lhs.type() != rhs.type()) {
-        kdl::log::fatal_error(lhs, 1, "Type mismatch in assertion. Both LHS and RHS must be of the same type.");
+        auto it = variables.find(op.lx.text());
+        if (it == variables.end()) {
+            kdl::log::fatal_error(op.lx, 1, "Unknown variable encountered in assertion '" + op.lx.text() + "'");
+        }
+        return operand(it->second).literal;
+    };
+
+    return compare(lookup(m_lhs), lookup(m_rhs));
+}
+
+auto kdl::assertion::compare(const value& lhs, const value& rhs) const -> bool
+{
+    if (lhs.type != rhs.type) {
+        kdl::log::fatal_error(m_lhs.lx, 1, "Type mismatch in assertion. Both LHS and RHS must be of the same type.");
     }
 
-    switch (lhs.type()) {
+    switch (lhs.type) {
         case kdl::lexeme::integer:
         case kdl::lexeme::res_id:
         case kdl::lexeme::percentage: {
-            auto v1 = lhs.value<__int128>();
-            auto v2 = rhs.value<__int128>();
+            const auto& v1 = lhs.number;
+            const auto& v2 = rhs.number;
 
             switch (m_operation) {
                 case lt:    return v1 < v2;
@@ -70,19 +159,19 @@ auto kdl::assertion::evaluate(std::unordered_map<std::string, lexeme> variables)
         };
 
         case kdl::lexeme::string: {
-            auto v1 = lhs.text();
-            auto v2 = rhs.text();
+            const auto& v1 = lhs.text;
+            const auto& v2 = rhs.text;
             switch (m_operation) {
                 case eq:    return v1 == v2;
                 case neq:   return v1 != v2;
                 default: {
-                    kdl::log::fatal_error(lhs, 1, "Operator not supported for string types.");
+                    kdl::log::fatal_error(m_lhs.lx, 1, "Operator not supported for string types.");
                 }
             }
         };
 
         default: {
-            kdl::log::fatal_error(lhs, 1, "Unsupported type found in assertion.");
+            kdl::log::fatal_error(m_lhs.lx, 1, "Unsupported type found in assertion.");
         }
     }
 }
@@ -92,7 +181,7 @@ auto kdl::assertion::evaluate(std::unordered_map<std::string, lexeme> variables)
 auto kdl::assertion::failure_text() const -> std::string
 {
     std::string reason;
-    reason.append(m_lhs.text());
+    reason.append(m_lhs.lx.text());
 
     switch (m_operation) {
         case lt:    reason.append(" must be less than "); break;
@@ -103,6 +192,6 @@ auto kdl::assertion::failure_text() const -> std::string
         case gt:    reason.append(" must be greater than "); break;
     }
 
-    reason.append(m_rhs.text());
+    reason.append(m_rhs.lx.text());
     return reason;
 }
\ No newline at end of file
@@ -20,8 +20,17 @@
 
 #pragma once
 
+#include <optional>
+#include <string_view>
 #include <unordered_map>
 #include "parser/lexeme.hpp"
+#include "target/new/binary_type.hpp"
+
+namespace kdl::build_target
+{
+    class type_template;
+    class resource_constructor;
+}
 
 namespace kdl
 {
@@ -30,17 +39,56 @@ namespace kdl
     {
     public:
         enum operation { lt, lteq, eq, neq, gteq, gt };
+
+        /**
+         * A value compared by an assertion. Numeric values are held decoded, and strings are viewed in place,
+         * so that no lexemes need to be produced in order to check a resource.
+         */
+        struct value
+        {
+            enum lexeme::type type { lexeme::integer };
+            __int128 number { 0 };
+            std::string_view text;
+        };
+
     public:
         assertion(const lexeme& lhs, enum operation op, const lexeme& rhs);
 
-        [[nodiscard]] auto evaluate(std::unordered_map<std::string, lexeme> variables) const -> bool;
+        [[nodiscard]] auto lhs() const -> lexeme;
+        [[nodiscard]] auto operation_type() const -> enum operation;
+        [[nodiscard]] auto rhs() const -> lexeme;
+
+        /**
+         * Resolve the operands of the assertion against the binary layout of the type that it belongs to, so that
+         * field values can be read directly from the value store of each resource.
+         */
+        auto compile(const build_target::type_template& tmpl) -> void;
+
+        [[nodiscard]] auto evaluate(const build_target::resource_constructor& resource) const -> bool;
+        [[nodiscard]] auto evaluate(const std::unordered_map<std::string, lexeme>& variables) const -> bool;
 
         [[nodiscard]] auto failure_text() const -> std::string;
 
     private:
-        lexeme m_lhs;
-        lexeme m_rhs;
+        struct operand
+        {
+            enum class source { literal, id, name, field, unknown };
+
+            lexeme lx;
+            enum source source { source::literal };
+            struct value literal;
+            enum build_target::binary_type type { build_target::binary_type::INVALID };
+
+            explicit operand(const lexeme& lx);
+        };
+
+        operand m_lhs;
+        operand m_rhs;
         enum operation m_operation;
+        bool m_compiled { false };
+
+        [[nodiscard]] static auto resolve(const operand& op, const build_target::resource_constructor& resource) -> value;
+        [[nodiscard]] auto compare(const value& lhs, const value& rhs) const -> bool;
 
     };
 
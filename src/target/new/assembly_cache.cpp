@@ -0,0 +1,351 @@
+// Copyright (c) 2022 Tom Hancocks
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <vector>
+#include "target/new/assembly_cache.hpp"
+#include "libGraphite/data/reader.hpp"
+#include "libGraphite/data/writer.hpp"
+
+namespace
+{
+    constexpr std::array<char, 4> entry_magic { 'K', 'D', 'L', 'C' };
+    constexpr const char *entry_extension = ".kdlc";
+
+    auto encode_u32(std::string& out, std::uint32_t value) -> void
+    {
+        for (auto i = 0; i < 4; ++i) {
+            out.push_back(static_cast<char>((value >> (i * 8)) & 0xFF));
+        }
+    }
+
+    auto encode_u64(std::string& out, std::uint64_t value) -> void
+    {
+        encode_u32(out, static_cast<std::uint32_t>(value & 0xFFFFFFFF));
+        encode_u32(out, static_cast<std::uint32_t>(value >> 32));
+    }
+
+    auto decode_u32(const char *in) -> std::uint32_t
+    {
+        std::uint32_t value = 0;
+        for (auto i = 0; i < 4; ++i) {
+            value |= static_cast<std::uint32_t>(static_cast<std::uint8_t>(in[i])) << (i * 8);
+        }
+        return value;
+    }
+
+    auto decode_u64(const char *in) -> std::uint64_t
+    {
+        return static_cast<std::uint64_t>(decode_u32(in)) | (static_cast<std::uint64_t>(decode_u32(in + 4)) << 32);
+    }
+
+    /**
+     * A checksum of the data in an entry, to detect an entry that has been damaged since it was stored.
+     */
+    auto data_checksum(const std::vector<char>& data) -> std::uint64_t
+    {
+        std::uint64_t hash = 14695981039346656037ULL;
+        for (auto c : data) {
+            hash ^= static_cast<std::uint8_t>(c);
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    constexpr std::array<std::uint32_t, 64> sha256_round_constants {
+        0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+        0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+        0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+        0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+        0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+        0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+        0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+        0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2
+    };
+
+    constexpr auto rotate_right(std::uint32_t value, int count) -> std::uint32_t
+    {
+        return (value >> count) | (value << (32 - count));
+    }
+}
+
+// MARK: - Content Digest
+
+auto kdl::build_target::content_digest::update(const void *data, std::size_t size) -> void
+{
+    auto bytes = static_cast<const std::uint8_t *>(data);
+    m_length += size;
+
+    while (size > 0) {
+        auto count = std::min(size, m_block.size() - m_block_size);
+        std::memcpy(m_block.data() + m_block_size, bytes, count);
+        m_block_size += count;
+        bytes += count;
+        size -= count;
+
+        if (m_block_size == m_block.size()) {
+            compress(m_state, m_block.data());
+            m_block_size = 0;
+        }
+    }
+}
+
+auto kdl::build_target::content_digest::update(std::string_view data) -> void
+{
+    update_value(static_cast<std::uint64_t>(data.size()));
+    update(data.data(), data.size());
+}
+
+auto kdl::build_target::content_digest::hex() const -> std::string
+{
+    // The padding is applied to a copy of the state, so that the digest can continue to be updated.
+    auto state = m_state;
+    auto block = m_block;
+    auto block_size = m_block_size;
+
+    block[block_size++] = 0x80;
+    if (block_size > 56) {
+        std::fill(block.begin() + static_cast<long>(block_size), block.end(), 0);
+        compress(state, block.data());
+        block_size = 0;
+    }
+    std::fill(block.begin() + static_cast<long>(block_size), block.begin() + 56, 0);
+
+    auto length = m_length * 8;
+    for (std::size_t i = 0; i < 8; ++i) {
+        block[63 - i] = static_cast<std::uint8_t>(length >> (i * 8));
+    }
+    compress(state, block.data());
+
+    static const char digits[] = "0123456789abcdef";
+    std::string out;
+    for (auto word : state) {
+        for (auto i = 7; i >= 0; --i) {
+            out.push_back(digits[(word >> (i * 4)) & 0xF]);
+        }
+    }
+    return out;
+}
+
+auto kdl::build_target::content_digest::compress(std::array<std::uint32_t, 8>& state, const std::uint8_t *block) -> void
+{
+    std::array<std::uint32_t, 64> schedule {};
+    for (std::size_t i = 0; i < 16; ++i) {
+        schedule[i] = (static_cast<std::uint32_t>(block[i * 4]) << 24)
+                    | (static_cast<std::uint32_t>(block[i * 4 + 1]) << 16)
+                    | (static_cast<std::uint32_t>(block[i * 4 + 2]) << 8)
+                    | static_cast<std::uint32_t>(block[i * 4 + 3]);
+    }
+    for (std::size_t i = 16; i < 64; ++i) {
+        auto s0 = rotate_right(schedule[i - 15], 7) ^ rotate_right(schedule[i - 15], 18) ^ (schedule[i - 15] >> 3);
+        auto s1 = rotate_right(schedule[i - 2], 17) ^ rotate_right(schedule[i - 2], 19) ^ (schedule[i - 2] >> 10);
+        schedule[i] = schedule[i - 16] + s0 + schedule[i - 7] + s1;
+    }
+
+    auto a = state[0], b = state[1], c = state[2], d = state[3];
+    auto e = state[4], f = state[5], g = state[6], h = state[7];
+    for (std::size_t i = 0; i < 64; ++i) {
+        auto t1 = h + (rotate_right(e, 6) ^ rotate_right(e, 11) ^ rotate_right(e, 25)) + ((e & f) ^ (~e & g)) + sha256_round_constants[i] + schedule[i];
+        auto t2 = (rotate_right(a, 2) ^ rotate_right(a, 13) ^ rotate_right(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+}
+
+// MARK: - Construction
+
+kdl::build_target::assembly_cache::assembly_cache(std::string path, std::uint64_t size_limit)
+    : m_path(std::move(path)), m_size_limit(size_limit)
+{
+
+}
+
+auto kdl::build_target::assembly_cache::path() const -> const std::string&
+{
+    return m_path;
+}
+
+auto kdl::build_target::assembly_cache::entry_path(const std::string& key) const -> std::string
+{
+    // Entries are spread over sub-directories by the first byte of their key, to keep directory sizes manageable.
+    return m_path + "/" + key.substr(0, 2) + "/" + key.substr(2) + entry_extension;
+}
+
+// MARK: - Entries
+
+auto kdl::build_target::assembly_cache::lookup(const std::string& key) -> std::optional<graphite::data::block>
+{
+    auto path = entry_path(key);
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        m_misses++;
+        return {};
+    }
+
+    // Entries begin with a header of the magic, the format version, the size of the key, the size of the data and a
+    // checksum of the data. The full key follows the header, so that an entry can not be mistaken for that of another
+    // key. Anything that does not match is treated as a miss, and will be replaced when the resource is stored again.
+    std::array<char, 24> header {};
+    in.read(header.data(), header.size());
+    if (static_cast<std::size_t>(in.gcount()) != header.size()
+        || std::memcmp(header.data(), entry_magic.data(), entry_magic.size()) != 0
+        || decode_u32(header.data() + 4) != format_version
+        || decode_u32(header.data() + 8) != key.size())
+    {
+        m_misses++;
+        return {};
+    }
+
+    std::string stored_key(key.size(), '\0');
+    in.read(stored_key.data(), static_cast<std::streamsize>(stored_key.size()));
+    if (static_cast<std::size_t>(in.gcount()) != stored_key.size() || stored_key != key) {
+        m_misses++;
+        return {};
+    }
+
+    std::vector<char> bytes(decode_u32(header.data() + 12));
+    in.read(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    if (static_cast<std::size_t>(in.gcount()) != bytes.size()
+        || in.peek() != std::char_traits<char>::eof()
+        || data_checksum(bytes) != decode_u64(header.data() + 16))
+    {
+        m_misses++;
+        return {};
+    }
+
+    std::error_code err;
+    std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), err);
+
+    m_hits++;
+    return graphite::data::block(bytes, graphite::data::byte_order::msb);
+}
+
+auto kdl::build_target::assembly_cache::store(const std::string& key, const graphite::data::block& data) -> void
+{
+    graphite::data::reader reader(&data);
+    auto bytes = reader.read_bytes(reader.size());
+
+    std::string entry(entry_magic.begin(), entry_magic.end());
+    encode_u32(entry, format_version);
+    encode_u32(entry, static_cast<std::uint32_t>(key.size()));
+    encode_u32(entry, static_cast<std::uint32_t>(bytes.size()));
+    encode_u64(entry, data_checksum(bytes));
+    entry.append(key);
+    entry.append(bytes.begin(), bytes.end());
+
+    // The cache is only an optimisation, so failing to write an entry is not an error.
+    auto path = entry_path(key);
+    std::error_code err;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), err);
+    if (err) {
+        return;
+    }
+
+    auto tmp_path = path + "." + std::to_string(std::random_device()()) + ".tmp";
+    {
+        std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+        out.write(entry.data(), static_cast<std::streamsize>(entry.size()));
+        if (!out.good()) {
+            out.close();
+            std::filesystem::remove(tmp_path, err);
+            return;
+        }
+    }
+
+    std::filesystem::rename(tmp_path, path, err);
+    if (err) {
+        std::filesystem::remove(tmp_path, err);
+    }
+}
+
+// MARK: - Eviction
+
+auto kdl::build_target::assembly_cache::evict() -> void
+{
+    struct entry
+    {
+        std::filesystem::path path;
+        std::uintmax_t size;
+        std::filesystem::file_time_type last_used;
+    };
+
+    std::error_code err;
+    std::vector<entry> entries;
+    std::uintmax_t total_size = 0;
+
+    for (auto it = std::filesystem::recursive_directory_iterator(m_path, err); !err && it != std::filesystem::recursive_directory_iterator(); it.increment(err)) {
+        if (!it->is_regular_file(err) || it->path().extension() != entry_extension) {
+            continue;
+        }
+
+        auto size = it->file_size(err);
+        auto last_used = it->last_write_time(err);
+        if (!err) {
+            entries.push_back({ it->path(), size, last_used });
+            total_size += size;
+        }
+    }
+
+    if (total_size <= m_size_limit) {
+        return;
+    }
+
+    std::sort(entries.begin(), entries.end(), [] (const entry& lhs, const entry& rhs) {
+        return lhs.last_used < rhs.last_used;
+    });
+
+    for (const auto& e : entries) {
+        if (total_size <= m_size_limit) {
+            break;
+        }
+        if (std::filesystem::remove(e.path, err)) {
+            total_size -= e.size;
+            m_evictions++;
+        }
+    }
+}
+
+// MARK: - Statistics
+
+auto kdl::build_target::assembly_cache::statistics() const -> assembly_cache_statistics
+{
+    return { m_hits.load(), m_misses.load(), m_evictions.load() };
+}
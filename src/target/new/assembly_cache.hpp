@@ -0,0 +1,127 @@
+// Copyright (c) 2022 Tom Hancocks
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include "libGraphite/data/data.hpp"
+
+namespace kdl::build_target
+{
+    /**
+     * An incremental SHA-256 digest of some content, used to address entries in the assembly cache. The digest is
+     * stable between runs and across platforms, and two different inputs will not share an entry.
+     */
+    class content_digest
+    {
+    public:
+        auto update(const void *data, std::size_t size) -> void;
+        auto update(std::string_view data) -> void;
+
+        template<typename T, typename std::enable_if<std::is_integral<T>::value>::type* = nullptr>
+        auto update_value(T value) -> void
+        {
+            std::uint8_t bytes[sizeof(T)];
+            for (std::size_t i = 0; i < sizeof(T); ++i) {
+                bytes[i] = static_cast<std::uint8_t>(static_cast<std::uint64_t>(value) >> (i * 8));
+            }
+            update(bytes, sizeof(T));
+        }
+
+        /**
+         * The digest of the content so far, as a hexadecimal string. More content may still be added afterwards.
+         */
+        [[nodiscard]] auto hex() const -> std::string;
+
+    private:
+        std::array<std::uint32_t, 8> m_state {
+            0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A, 0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19
+        };
+        std::array<std::uint8_t, 64> m_block {};
+        std::size_t m_block_size { 0 };
+        std::uint64_t m_length { 0 };
+
+        static auto compress(std::array<std::uint32_t, 8>& state, const std::uint8_t *block) -> void;
+    };
+
+    /**
+     * Counters describing how often assembled resources were reused from the cache.
+     */
+    struct assembly_cache_statistics
+    {
+        std::size_t hits { 0 };
+        std::size_t misses { 0 };
+        std::size_t evictions { 0 };
+    };
+
+    /**
+     * An on disk cache of assembled resource data. Each entry is addressed by a digest of everything that the data
+     * was assembled from, so an entry never needs to be invalidated; when the inputs change the digest changes with
+     * them. Entries that are no longer used are removed, least recently used first, once the cache grows beyond
+     * its size limit.
+     *
+     * The cache may be used from several assembly jobs at once.
+     */
+    class assembly_cache
+    {
+    public:
+        static constexpr std::uint32_t format_version = 2;
+        static constexpr std::uint64_t default_size_limit = 256ULL * 1024 * 1024;
+
+        explicit assembly_cache(std::string path, std::uint64_t size_limit = default_size_limit);
+
+        [[nodiscard]] auto path() const -> const std::string&;
+
+        /**
+         * Look up the assembled data for the specified key. An entry is only used if it was stored for the same key,
+         * and its data is intact. A hit marks the entry as recently used.
+         */
+        auto lookup(const std::string& key) -> std::optional<graphite::data::block>;
+
+        /**
+         * Store the assembled data for the specified key. Entries are written to a temporary file and then moved
+         * into place, so that a partially written entry is never seen.
+         */
+        auto store(const std::string& key, const graphite::data::block& data) -> void;
+
+        /**
+         * Remove the least recently used entries until the cache is within its size limit.
+         */
+        auto evict() -> void;
+
+        [[nodiscard]] auto statistics() const -> assembly_cache_statistics;
+
+    private:
+        std::string m_path;
+        std::uint64_t m_size_limit;
+        std::atomic<std::size_t> m_hits { 0 };
+        std::atomic<std::size_t> m_misses { 0 };
+        std::atomic<std::size_t> m_evictions { 0 };
+
+        [[nodiscard]] auto entry_path(const std::string& key) const -> std::string;
+    };
+}
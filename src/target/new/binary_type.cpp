@@ -182,3 +182,32 @@ auto kdl::build_target::binary_type_base_size(enum kdl::build_target::binary_typ
             return 0;
     }
 }
+
+auto kdl::build_target::binary_type_name(enum kdl::build_target::binary_type type) -> std::string
+{
+    switch (type & ~0xFFF) {
+        case binary_type::DBYT: return "DBYT";
+        case binary_type::DWRD: return "DWRD";
+        case binary_type::DLNG: return "DLNG";
+        case binary_type::DQAD: return "DQAD";
+        case binary_type::HBYT: return "HBYT";
+        case binary_type::HWRD: return "HWRD";
+        case binary_type::HLNG: return "HLNG";
+        case binary_type::HQAD: return "HQAD";
+        case binary_type::HEXD: return "HEXD";
+        case binary_type::PSTR: return "PSTR";
+        case binary_type::CSTR: return "CSTR";
+        case binary_type::RECT: return "RECT";
+        case binary_type::OCNT: return "OCNT";
+        case binary_type::LSTE: return "LSTE";
+        case binary_type::LSTC: return "LSTC";
+        case binary_type::RSRC: return "RSRC";
+        case binary_type::Cnnn: {
+            static const char *digits = "0123456789ABCDEF";
+            auto width = static_cast<std::uint32_t>(type) & 0xFFF;
+            return { 'C', digits[(width >> 8) & 0xF], digits[(width >> 4) & 0xF], digits[width & 0xF] };
+        }
+        default:
+            return "INVALID";
+    }
+}
@@ -92,5 +92,6 @@ namespace kdl::build_target
 
     auto binary_type_for_name(const std::string& name) -> enum binary_type;
     auto binary_type_base_size(enum binary_type type) -> std::size_t;
+    auto binary_type_name(enum binary_type type) -> std::string;
 
 };
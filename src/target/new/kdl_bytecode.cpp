@@ -0,0 +1,542 @@
+// Copyright (c) 2022 Tom Hancocks
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <algorithm>
+#include <stdexcept>
+#include "target/new/kdl_bytecode.hpp"
+#include "target/new/kdl_expression.hpp"
+#include "diagnostic/fatal.hpp"
+#include "target/target.hpp"
+
+// MARK: - Arithmetic
+
+namespace
+{
+    using opcode = kdl::build_target::kdl_bytecode::opcode;
+
+    auto apply_binary(opcode op, std::int64_t lhs, std::int64_t rhs) -> std::int64_t
+    {
+        switch (op) {
+            case opcode::add:           return lhs + rhs;
+            case opcode::subtract:      return lhs - rhs;
+            case opcode::multiply:      return lhs * rhs;
+            case opcode::divide:        return lhs / rhs;
+            case opcode::exclusive_or:  return lhs ^ rhs;
+            case opcode::bitwise_and:   return lhs & rhs;
+            case opcode::bitwise_or:    return lhs | rhs;
+            case opcode::shift_left:    return lhs << rhs;
+            case opcode::shift_right:   return lhs >> rhs;
+            default:
+                throw std::logic_error("[kdl::build_target::kdl_bytecode] Unrecognised instruction encountered.");
+        }
+    }
+}
+
+// MARK: - Values
+
+auto kdl::build_target::kdl_value::of(const lexeme &lx) -> kdl_value
+{
+    kdl_value value;
+    value.type = lx.type();
+    value.source = lx;
+    if (value.is_numeric()) {
+        value.number = lx.value<std::int64_t>();
+    }
+    return value;
+}
+
+auto kdl::build_target::kdl_value::numeric(enum lexeme::type type, std::int64_t number) -> kdl_value
+{
+    kdl_value value;
+    value.type = type;
+    value.number = number;
+    return value;
+}
+
+auto kdl::build_target::kdl_value::is_numeric() const -> bool
+{
+    return type == lexeme::integer || type == lexeme::percentage || type == lexeme::res_id;
+}
+
+auto kdl::build_target::kdl_value::to_lexeme() const -> lexeme
+{
+    if (source.has_value()) {
+        return source.value();
+    }
+    return { std::to_string(number), type };
+}
+
+// MARK: - Construction
+
+auto kdl::build_target::kdl_bytecode::builtin_named(const std::string &name) -> std::optional<enum builtin>
+{
+    if (name == "__postIncrement") {
+        return builtin::post_increment;
+    }
+    else if (name == "__preIncrement") {
+        return builtin::pre_increment;
+    }
+    else if (name == "__postDecrement") {
+        return builtin::post_decrement;
+    }
+    else if (name == "__preDecrement") {
+        return builtin::pre_decrement;
+    }
+    else if (name == "__integer") {
+        return builtin::integer;
+    }
+    else if (name == "__string") {
+        return builtin::string;
+    }
+    else if (name == "__percentage") {
+        return builtin::percentage;
+    }
+    else if (name == "__resource_id") {
+        return builtin::resource_id;
+    }
+    return {};
+}
+
+auto kdl::build_target::kdl_bytecode::set_single_value(bool single_value) -> void
+{
+    m_single_value = single_value;
+}
+
+auto kdl::build_target::kdl_bytecode::set_origin(const lexeme &lx) -> void
+{
+    m_origin = lx;
+}
+
+auto kdl::build_target::kdl_bytecode::emit(enum opcode op, std::uint32_t operand, int depth_change) -> void
+{
+    m_code.push_back({ op, operand });
+
+    // Malformed expressions are reported when they are executed, so just avoid wrapping the depth here.
+    if (depth_change < 0 && m_depth < static_cast<std::size_t>(-depth_change)) {
+        m_depth = 0;
+    }
+    else {
+        m_depth += depth_change;
+    }
+    m_max_depth = std::max(m_max_depth, m_depth);
+}
+
+auto kdl::build_target::kdl_bytecode::slot_for(const lexeme &name) -> std::uint32_t
+{
+    for (std::uint32_t i = 0; i < m_slots.size(); ++i) {
+        if (m_slots[i].name.symbol() == name.symbol()) {
+            return i;
+        }
+    }
+
+    // Arguments are referenced as $1, $2, $3... so resolve those to their argument index now.
+    variable_slot slot { name, -1 };
+    const auto& text = name.text();
+    if (!text.empty() && text.size() < 10 && std::all_of(text.begin(), text.end(), [] (char c) { return c >= '0' && c <= '9'; })) {
+        auto index = std::stol(text);
+        if (index > 0) {
+            slot.argument = static_cast<std::int32_t>(index - 1);
+        }
+    }
+
+    m_slots.emplace_back(slot);
+    return static_cast<std::uint32_t>(m_slots.size() - 1);
+}
+
+auto kdl::build_target::kdl_bytecode::push_constant(const lexeme &value) -> void
+{
+    m_constants.emplace_back(kdl_value::of(value));
+    emit(opcode::push_constant, static_cast<std::uint32_t>(m_constants.size() - 1), 1);
+}
+
+auto kdl::build_target::kdl_bytecode::load_variable(const lexeme &name) -> void
+{
+    emit(opcode::load_variable, slot_for(name), 1);
+}
+
+auto kdl::build_target::kdl_bytecode::call_function(const lexeme &name, std::vector<kdl_bytecode> arguments) -> void
+{
+    m_calls.push_back({ name, std::move(arguments), nullptr });
+    emit(opcode::call_function, static_cast<std::uint32_t>(m_calls.size() - 1), 1);
+}
+
+auto kdl::build_target::kdl_bytecode::call_builtin(enum builtin function, const lexeme &name, const lexeme &var) -> void
+{
+    m_builtins.push_back({ function, name, slot_for(var) });
+    emit(opcode::call_builtin, static_cast<std::uint32_t>(m_builtins.size() - 1), 1);
+}
+
+auto kdl::build_target::kdl_bytecode::apply_operator(const lexeme &op) -> void
+{
+    enum opcode code;
+    switch (op.type()) {
+        case lexeme::plus:          code = opcode::add; break;
+        case lexeme::minus:         code = opcode::subtract; break;
+        case lexeme::star:          code = opcode::multiply; break;
+        case lexeme::slash:         code = opcode::divide; break;
+        case lexeme::carat:         code = opcode::exclusive_or; break;
+        case lexeme::amp:           code = opcode::bitwise_and; break;
+        case lexeme::pipe:          code = opcode::bitwise_or; break;
+        case lexeme::left_shift:    code = opcode::shift_left; break;
+        case lexeme::right_shift:   code = opcode::shift_right; break;
+        case lexeme::tilde:         code = opcode::bitwise_not; break;
+        default:
+            throw std::logic_error("[kdl::build_target::kdl_bytecode] Attempted to apply an unrecognised operator.");
+    }
+
+    if (!fold(code)) {
+        emit(code, 0, code == opcode::bitwise_not ? 0 : -1);
+    }
+}
+
+auto kdl::build_target::kdl_bytecode::fold(enum opcode op) -> bool
+{
+    // Operators whose operands are all constants are evaluated now, and replaced by their result.
+    const std::size_t operands = (op == opcode::bitwise_not) ? 1 : 2;
+    if (m_code.size() < operands) {
+        return false;
+    }
+    for (auto i = m_code.size() - operands; i < m_code.size(); ++i) {
+        if (m_code[i].op != opcode::push_constant) {
+            return false;
+        }
+    }
+
+    if (op == opcode::bitwise_not) {
+        auto& value = m_constants[m_code.back().operand];
+        value.number = ~value.number;
+        value.source.reset();
+        return true;
+    }
+
+    const auto& lhs = m_constants[m_code[m_code.size() - 2].operand];
+    const auto& rhs = m_constants[m_code.back().operand];
+
+    // Leave anything that would fail to the point of execution, so that it is diagnosed in the same way.
+    if ((lhs.type == lexeme::res_id && rhs.type == lexeme::percentage) || (lhs.type == lexeme::percentage && rhs.type == lexeme::res_id)) {
+        return false;
+    }
+    if (op == opcode::divide && rhs.number == 0) {
+        return false;
+    }
+
+    auto result = kdl_value::numeric((lhs.type == lexeme::integer) ? rhs.type : lhs.type, apply_binary(op, lhs.number, rhs.number));
+
+    m_code.pop_back();
+    m_constants[m_code.back().operand] = result;
+    m_depth -= 1;
+    return true;
+}
+
+// MARK: - Accessors
+
+auto kdl::build_target::kdl_bytecode::is_single_value() const -> bool
+{
+    return m_single_value;
+}
+
+auto kdl::build_target::kdl_bytecode::instructions() const -> const std::vector<instruction>&
+{
+    return m_code;
+}
+
+auto kdl::build_target::kdl_bytecode::max_stack_depth() const -> std::size_t
+{
+    return m_max_depth;
+}
+
+auto kdl::build_target::kdl_bytecode::has_side_effects(const kdl::target& target) const -> bool
+{
+    for (const auto& site : m_builtins) {
+        switch (site.function) {
+            case builtin::post_increment:
+            case builtin::pre_increment:
+            case builtin::post_decrement:
+            case builtin::pre_decrement:
+                return true;
+            default:
+                break;
+        }
+    }
+
+    for (const auto& site : m_calls) {
+        for (const auto& argument : site.arguments) {
+            if (argument.has_side_effects(target)) {
+                return true;
+            }
+        }
+
+        auto function = site.function ? site.function : target.function_expression(site.name.text());
+        if (function && function->bytecode().has_side_effects(target)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+auto kdl::build_target::kdl_bytecode::is_pure(const kdl::target& target) const -> bool
+{
+    if (has_side_effects(target)) {
+        return false;
+    }
+
+    for (const auto& slot : m_slots) {
+        if (slot.argument >= 0) {
+            continue;
+        }
+        if (!target.global_value(slot.name.symbol()) || target.is_global_variable_mutable(slot.name.symbol())) {
+            return false;
+        }
+    }
+
+    for (const auto& site : m_calls) {
+        for (const auto& argument : site.arguments) {
+            if (!argument.is_pure(target)) {
+                return false;
+            }
+        }
+
+        auto function = site.function ? site.function : target.function_expression(site.name.text());
+        if (!function || !function->is_pure(target)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+auto kdl::build_target::kdl_bytecode::references_arguments() const -> bool
+{
+    for (const auto& slot : m_slots) {
+        if (slot.argument >= 0) {
+            return true;
+        }
+    }
+
+    for (const auto& site : m_calls) {
+        for (const auto& argument : site.arguments) {
+            if (argument.references_arguments()) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+// MARK: - Execution
+
+auto kdl::build_target::kdl_bytecode::execute(const environment &env) const -> kdl_value
+{
+    if (m_single_value) {
+        if (m_code.size() != 1) {
+            throw std::logic_error("[kdl::build_target::kdl_bytecode] A single value program must contain exactly one instruction.");
+        }
+        return operand(m_code.front(), env);
+    }
+
+    if (m_max_depth <= inline_stack_size) {
+        std::array<std::int64_t, inline_stack_size> stack {};
+        return run(env, stack.data());
+    }
+
+    std::vector<std::int64_t> stack(m_max_depth);
+    return run(env, stack.data());
+}
+
+auto kdl::build_target::kdl_bytecode::run(const environment &env, std::int64_t *stack) const -> kdl_value
+{
+    std::size_t sp = 0;
+    auto result_type = lexeme::integer;
+
+    const auto require = [&] (std::size_t count) {
+        if (sp < count) {
+            throw std::logic_error("There was an error evaluating the expression. Stack size was " + std::to_string(sp));
+        }
+    };
+
+    for (const auto& in : m_code) {
+        switch (in.op) {
+            case opcode::push_constant:
+            case opcode::load_variable:
+            case opcode::call_function:
+            case opcode::call_builtin: {
+                const auto value = operand(in, env);
+                if (value.type == lexeme::res_id) {
+                    if (result_type == lexeme::percentage) {
+                        log::fatal_error(value.source.value_or(m_origin.value_or(lexeme("", lexeme::any))), 1, "Value is incompatible with current expression result type of 'percentage'");
+                    }
+                    result_type = lexeme::res_id;
+                }
+                else if (value.type == lexeme::percentage) {
+                    if (result_type == lexeme::res_id) {
+                        log::fatal_error(value.source.value_or(m_origin.value_or(lexeme("", lexeme::any))), 1, "Value is incompatible with current expression result type of 'resource_id'");
+                    }
+                    result_type = lexeme::percentage;
+                }
+                else if (value.type != lexeme::integer) {
+                    // Non-numeric values do not participate in arithmetic and are discarded.
+                    break;
+                }
+                stack[sp++] = value.number;
+                break;
+            }
+            case opcode::bitwise_not: {
+                require(1);
+                stack[sp - 1] = ~stack[sp - 1];
+                break;
+            }
+            default: {
+                require(2);
+                const auto rhs = stack[--sp];
+                auto& lhs = stack[sp - 1];
+                if (in.op == opcode::divide && rhs == 0) {
+                    log::fatal_error(m_origin.value_or(lexeme("", lexeme::any)), 1, "Division by zero in expression.");
+                }
+                lhs = apply_binary(in.op, lhs, rhs);
+                break;
+            }
+        }
+    }
+
+    if (sp != 1) {
+        throw std::logic_error("There was an error evaluating the expression. Stack size was " + std::to_string(sp));
+    }
+
+    return kdl_value::numeric(result_type, stack[0]);
+}
+
+auto kdl::build_target::kdl_bytecode::operand(const instruction &in, const environment &env) const -> kdl_value
+{
+    switch (in.op) {
+        case opcode::push_constant: {
+            return m_constants[in.operand];
+        }
+        case opcode::load_variable: {
+            const auto& slot = m_slots[in.operand];
+            if (auto value = resolve(slot, env)) {
+                return value.value();
+            }
+            log::fatal_error(slot.name, 1, m_single_value ? "Unrecognised variable referenced." : "Unrecognised variable reference.");
+        }
+        case opcode::call_function: {
+            return call(m_calls[in.operand], env);
+        }
+        case opcode::call_builtin: {
+            return call(m_builtins[in.operand], env);
+        }
+        default:
+            throw std::logic_error("[kdl::build_target::kdl_bytecode] Instruction does not produce an operand.");
+    }
+}
+
+auto kdl::build_target::kdl_bytecode::resolve(const variable_slot &slot, const environment &env) const -> std::optional<kdl_value>
+{
+    if (slot.argument >= 0 && static_cast<std::size_t>(slot.argument) < env.argument_count) {
+        return env.arguments[slot.argument];
+    }
+
+    if (env.vars) {
+        auto it = env.vars->find(slot.name.text());
+        if (it != env.vars->end()) {
+            return kdl_value::of(it->second);
+        }
+    }
+
+    if (env.target) {
+        if (auto global = env.target->global_value(slot.name.symbol())) {
+            return *global;
+        }
+    }
+
+    return {};
+}
+
+auto kdl::build_target::kdl_bytecode::call(const call_site &site, const environment &env) const -> kdl_value
+{
+    if (!site.function) {
+        site.function = env.target->function_expression(site.name.text());
+        if (!site.function) {
+            log::fatal_error(site.name, 1, "Unrecognised function '" + site.name.text() + "' referenced.");
+        }
+    }
+
+    const auto count = site.arguments.size();
+    if (count <= inline_argument_count) {
+        std::array<kdl_value, inline_argument_count> arguments;
+        for (std::size_t i = 0; i < count; ++i) {
+            arguments[i] = site.arguments[i].execute(env);
+        }
+        return site.function->call(env.target, arguments.data(), count);
+    }
+
+    std::vector<kdl_value> arguments;
+    arguments.reserve(count);
+    for (const auto& argument : site.arguments) {
+        arguments.emplace_back(argument.execute(env));
+    }
+    return site.function->call(env.target, arguments.data(), count);
+}
+
+auto kdl::build_target::kdl_bytecode::call(const builtin_call &site, const environment &env) const -> kdl_value
+{
+    const auto& slot = m_slots[site.slot];
+    auto value = resolve(slot, env);
+    if (!value.has_value()) {
+        log::fatal_error(slot.name, 1, "Unrecognised variable name referenced.");
+    }
+
+    if (!value->is_numeric()) {
+        log::fatal_error(value->to_lexeme(), 1, "The built-in function '" + site.name.text() + "' requires a variable for a numeric value to be specified as an argument.");
+    }
+
+    switch (site.function) {
+        case builtin::post_increment:
+        case builtin::pre_increment:
+        case builtin::post_decrement:
+        case builtin::pre_decrement: {
+            const auto delta = (site.function == builtin::post_increment || site.function == builtin::pre_increment) ? 1 : -1;
+            kdl_value updated;
+            updated.type = value->type;
+            updated.number = value->number + delta;
+            env.target->set_global_variable(slot.name.symbol(), updated);
+            if (site.function == builtin::post_increment || site.function == builtin::post_decrement) {
+                return value.value();
+            }
+            return updated;
+        }
+        case builtin::integer: {
+            return kdl_value::of(lexeme(value->to_lexeme().text(), lexeme::integer));
+        }
+        case builtin::string: {
+            return kdl_value::of(lexeme(value->to_lexeme().text(), lexeme::string));
+        }
+        case builtin::percentage: {
+            return kdl_value::of(lexeme(value->to_lexeme().text(), lexeme::percentage));
+        }
+        case builtin::resource_id: {
+            return kdl_value::of(lexeme(value->to_lexeme().text(), lexeme::res_id));
+        }
+    }
+
+    throw std::logic_error("[kdl::build_target::kdl_bytecode] Unrecognised built-in function.");
+}
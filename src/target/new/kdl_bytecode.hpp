@@ -0,0 +1,184 @@
+// Copyright (c) 2022 Tom Hancocks
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "parser/lexeme.hpp"
+
+namespace kdl
+{
+    class target;
+}
+
+namespace kdl::build_target
+{
+    struct kdl_expression;
+
+    /**
+     * A single value produced or consumed by a compiled expression. Numeric values are held pre-decoded, and the
+     * lexeme that the value originated from is retained (when there is one) so that it can be returned verbatim and
+     * used for diagnostics.
+     */
+    struct kdl_value
+    {
+    public:
+        enum lexeme::type type { lexeme::integer };
+        std::int64_t number { 0 };
+        std::optional<lexeme> source;
+
+        static auto of(const lexeme& lx) -> kdl_value;
+        static auto numeric(enum lexeme::type type, std::int64_t number) -> kdl_value;
+
+        [[nodiscard]] auto is_numeric() const -> bool;
+        [[nodiscard]] auto to_lexeme() const -> lexeme;
+    };
+
+    /**
+     * A KDL expression compiled into a flat sequence of instructions in reverse polish order. Variable references
+     * are resolved to slots up front, and numeric constants are decoded at compile time, so that evaluating the
+     * program is a single pass over the instructions using a fixed size stack.
+     *
+     * A program is either an arithmetic program, or a single value program. Single value programs return their one
+     * operand verbatim (strings included) and mirror the shortcut taken by the reference evaluator for expressions
+     * consisting of a single lexeme.
+     */
+    struct kdl_bytecode
+    {
+    public:
+        enum class opcode : std::uint8_t
+        {
+            push_constant, load_variable, call_function, call_builtin,
+            add, subtract, multiply, divide, exclusive_or, bitwise_and, bitwise_or, bitwise_not, shift_left, shift_right
+        };
+
+        enum class builtin : std::uint8_t
+        {
+            post_increment, pre_increment, post_decrement, pre_decrement,
+            integer, string, percentage, resource_id
+        };
+
+        struct instruction
+        {
+            enum opcode op;
+            std::uint32_t operand { 0 };
+        };
+
+        /**
+         * The values available to a program whilst it is executing. Arguments take precedence over variables,
+         * which in turn take precedence over the global variables of the target.
+         */
+        struct environment
+        {
+            std::shared_ptr<kdl::target> target;
+            const kdl_value *arguments { nullptr };
+            std::size_t argument_count { 0 };
+            const std::unordered_map<std::string, lexeme> *vars { nullptr };
+        };
+
+        static constexpr std::size_t inline_stack_size = 32;
+        static constexpr std::size_t inline_argument_count = 8;
+
+    public:
+        kdl_bytecode() = default;
+
+        static auto builtin_named(const std::string& name) -> std::optional<enum builtin>;
+
+        auto set_single_value(bool single_value) -> void;
+        auto set_origin(const lexeme& lx) -> void;
+
+        auto push_constant(const lexeme& value) -> void;
+        auto load_variable(const lexeme& name) -> void;
+        auto call_function(const lexeme& name, std::vector<kdl_bytecode> arguments) -> void;
+        auto call_builtin(enum builtin function, const lexeme& name, const lexeme& var) -> void;
+        auto apply_operator(const lexeme& op) -> void;
+
+        [[nodiscard]] auto is_single_value() const -> bool;
+        [[nodiscard]] auto instructions() const -> const std::vector<instruction>&;
+        [[nodiscard]] auto max_stack_depth() const -> std::size_t;
+
+        /**
+         * Determine if executing the program may modify global variables, either directly through one of the
+         * increment/decrement built-ins, or indirectly through a function that it calls.
+         */
+        [[nodiscard]] auto has_side_effects(const kdl::target& target) const -> bool;
+
+        /**
+         * Determine if the result of the program depends only upon its arguments. A pure program has no side
+         * effects, and only refers to arguments, immutable global variables and other pure functions.
+         */
+        [[nodiscard]] auto is_pure(const kdl::target& target) const -> bool;
+
+        /**
+         * Determine if the program refers to any of the arguments ($1, $2, $3...) that it is called with.
+         */
+        [[nodiscard]] auto references_arguments() const -> bool;
+
+        [[nodiscard]] auto execute(const environment& env) const -> kdl_value;
+
+    private:
+        struct variable_slot
+        {
+            lexeme name;
+            std::int32_t argument { -1 };
+        };
+
+        struct call_site
+        {
+            lexeme name;
+            std::vector<kdl_bytecode> arguments;
+            mutable std::shared_ptr<kdl_expression> function;
+        };
+
+        struct builtin_call
+        {
+            enum builtin function;
+            lexeme name;
+            std::uint32_t slot;
+        };
+
+        bool m_single_value { false };
+        std::optional<lexeme> m_origin;
+        std::vector<instruction> m_code;
+        std::vector<kdl_value> m_constants;
+        std::vector<variable_slot> m_slots;
+        std::vector<call_site> m_calls;
+        std::vector<builtin_call> m_builtins;
+        std::size_t m_depth { 0 };
+        std::size_t m_max_depth { 0 };
+
+        auto emit(enum opcode op, std::uint32_t operand, int depth_change) -> void;
+        auto fold(enum opcode op) -> bool;
+        auto slot_for(const lexeme& name) -> std::uint32_t;
+
+        [[nodiscard]] auto run(const environment& env, std::int64_t *stack) const -> kdl_value;
+        [[nodiscard]] auto operand(const instruction& in, const environment& env) const -> kdl_value;
+        [[nodiscard]] auto resolve(const variable_slot& slot, const environment& env) const -> std::optional<kdl_value>;
+        [[nodiscard]] auto call(const call_site& site, const environment& env) const -> kdl_value;
+        [[nodiscard]] auto call(const builtin_call& site, const environment& env) const -> kdl_value;
+    };
+}
@@ -19,6 +19,7 @@
 // SOFTWARE.
 
 #include "target/new/kdl_expression.hpp"
+#include "parser/sema/expression/expression_compiler.hpp"
 #include "parser/sema/expression/expression_parser.hpp"
 #include "diagnostic/fatal.hpp"
 #include "target/target.hpp"
@@ -31,16 +32,174 @@ kdl::build_target::kdl_expression::kdl_expression(const std::vector<lexeme> &lex
     : m_lexemes(std::move(lexemes))
 {}
 
+auto kdl::build_target::kdl_expression::copy() const -> std::shared_ptr<kdl_expression>
+{
+    auto expression = std::make_shared<kdl_expression>(m_lexemes);
+    expression->m_foldable = m_foldable;
+    return expression;
+}
+
+// MARK: - Accessors
+
+auto kdl::build_target::kdl_expression::lexemes() const -> const std::vector<lexeme>&
+{
+    return m_lexemes;
+}
+
+auto kdl::build_target::kdl_expression::bytecode() const -> const kdl_bytecode&
+{
+    if (!m_bytecode) {
+        m_bytecode = std::make_shared<const kdl_bytecode>(sema::expression_compiler::compile(m_lexemes));
+    }
+    return *m_bytecode;
+}
+
 // MARK: - Evaluation
 
 auto kdl::build_target::kdl_expression::evaluate(std::weak_ptr<target> target, const std::vector<lexeme> &arguments, const std::unordered_map<std::string, kdl::lexeme>& vars) const -> lexeme
 {
-    std::unordered_map<std::string, lexeme> local_vars;
+    auto t = target.lock();
+    if (!t) {
+        throw std::runtime_error("Missing build target. This is a bug.");
+    }
+
+    std::vector<kdl_value> values;
+    values.reserve(arguments.size());
+    for (const auto& argument : arguments) {
+        values.emplace_back(kdl_value::of(argument));
+    }
+
+    auto result = invoke(t, values.data(), values.size(), &vars).to_lexeme();
+
+    if (t->verifies_expressions()) {
+        verify(t, result, arguments, vars);
+    }
+    return result;
+}
+
+auto kdl::build_target::kdl_expression::call(const std::shared_ptr<target> &target, const kdl_value *arguments, std::size_t count) const -> kdl_value
+{
+    auto result = invoke(target, arguments, count, nullptr);
 
-    // Capture global variables if they are available.
-    if (auto t = target.lock()) {
-        local_vars = t->all_global_variables();
+    if (target->verifies_expressions()) {
+        std::vector<lexeme> argument_lexemes;
+        for (std::size_t i = 0; i < count; ++i) {
+            argument_lexemes.emplace_back(arguments[i].to_lexeme());
+        }
+        verify(target, result.to_lexeme(), argument_lexemes, {});
     }
+    return result;
+}
+
+auto kdl::build_target::kdl_expression::invoke(const std::shared_ptr<target> &target, const kdl_value *arguments, std::size_t count, const std::unordered_map<std::string, kdl::lexeme> *vars) const -> kdl_value
+{
+    kdl_bytecode::environment env { target, arguments, count, vars };
+
+    // Variables supplied by the caller may shadow globals, so only results that depend solely upon the arguments
+    // can be reused.
+    if ((vars && !vars->empty()) || !is_pure(*target)) {
+        return bytecode().execute(env);
+    }
+
+    if (m_folded.has_value()) {
+        target->expression_statistics().hits++;
+        return m_folded.value();
+    }
+    else if (!bytecode().references_arguments()) {
+        if (!m_foldable) {
+            return bytecode().execute(env);
+        }
+        m_folded = bytecode().execute(env);
+        target->expression_statistics().folded++;
+        return m_folded.value();
+    }
+
+    // Literal arguments are not interned, so arguments are compared by their text rather than by their symbol.
+    std::size_t hash = count;
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto text = arguments[i].source.has_value() ? arguments[i].source->text_view() : std::string_view();
+        hash ^= std::hash<std::int64_t>()(arguments[i].number) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+        hash ^= std::hash<std::string_view>()(text) + arguments[i].type + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    }
+
+    auto range = m_memo.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        const auto& memo = it->second.arguments;
+        if (memo.size() != count) {
+            continue;
+        }
+
+        auto matches = true;
+        for (std::size_t i = 0; matches && i < count; ++i) {
+            const auto text = arguments[i].source.has_value() ? arguments[i].source->text_view() : std::string_view();
+            matches = memo[i].type == arguments[i].type && memo[i].number == arguments[i].number && memo[i].text == text;
+        }
+
+        if (matches) {
+            target->expression_statistics().hits++;
+            return it->second.result;
+        }
+    }
+
+    target->expression_statistics().misses++;
+    auto result = bytecode().execute(env);
+
+    memo_entry entry { {}, result };
+    entry.arguments.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto text = arguments[i].source.has_value() ? arguments[i].source->text_view() : std::string_view();
+        entry.arguments.push_back({ arguments[i].type, arguments[i].number, std::string(text) });
+    }
+    if (m_memo.size() >= memo_limit) {
+        m_memo.clear();
+    }
+    m_memo.emplace(hash, std::move(entry));
+
+    return result;
+}
+
+// MARK: - Purity
+
+auto kdl::build_target::kdl_expression::is_pure(const target &target) const -> bool
+{
+    if (m_pure.has_value() && m_purity_generation == target.global_generation()) {
+        return m_pure.value();
+    }
+
+    // A function that refers back to itself can not be shown to be pure.
+    if (m_checking_purity) {
+        return false;
+    }
+
+    m_checking_purity = true;
+    auto pure = bytecode().is_pure(target);
+    m_checking_purity = false;
+
+    m_pure = pure;
+    m_purity_generation = target.global_generation();
+    if (!pure) {
+        m_folded.reset();
+        m_memo.clear();
+    }
+    return pure;
+}
+
+auto kdl::build_target::kdl_expression::allow_folding() -> void
+{
+    m_foldable = true;
+}
+
+
+// MARK: - Verification
+
+auto kdl::build_target::kdl_expression::verify(const std::shared_ptr<target>& target, const lexeme& result, const std::vector<lexeme> &arguments, const std::unordered_map<std::string, kdl::lexeme>& vars) const -> void
+{
+    // Evaluating the expression a second time would apply any side effects twice, so those are not checked.
+    if (bytecode().has_side_effects(*target)) {
+        return;
+    }
+
+    std::unordered_map<std::string, lexeme> local_vars(target->all_global_variables());
 
     for (const auto& var : vars) {
         auto it = local_vars.find(var.first);
@@ -63,10 +222,9 @@ auto kdl::build_target::kdl_expression::evaluate(std::weak_ptr<target> target, c
         }
     }
 
-    if (auto t = target.lock()) {
-        return sema::expression_parser::evaluate(t, m_lexemes, local_vars);
-    }
-    else {
-        throw std::runtime_error("Missing build target. This is a bug.");
+    auto expected = sema::expression_parser::evaluate(target, m_lexemes, local_vars);
+    if (!expected.is(result.type()) || expected.text() != result.text()) {
+        auto lx = m_lexemes.empty() ? result : m_lexemes.front();
+        log::fatal_error(lx, 1, "Compiled expression evaluated to '" + result.text() + "', but the reference evaluator produced '" + expected.text() + "'.");
     }
 }
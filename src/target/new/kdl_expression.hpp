@@ -20,9 +20,14 @@
 
 #pragma once
 
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
 #include <vector>
 #include <unordered_map>
 #include "parser/lexeme.hpp"
+#include "target/new/kdl_bytecode.hpp"
 
 namespace kdl
 {
@@ -31,14 +36,86 @@ namespace kdl
 
 namespace kdl::build_target
 {
+    /**
+     * Counters describing how often the results of expressions were reused, rather than being evaluated again.
+     */
+    struct expression_statistics
+    {
+        std::size_t folded { 0 };
+        std::size_t hits { 0 };
+        std::size_t misses { 0 };
+    };
+
     struct kdl_expression
     {
     public:
         explicit kdl_expression(const std::vector<lexeme>& lexemes);
 
+        /**
+         * Create a new expression with the same lexemes, that shares none of the results or compiled code cached by
+         * this one. Expressions update their caches as they are evaluated, so each thread needs its own copy.
+         */
+        [[nodiscard]] auto copy() const -> std::shared_ptr<kdl_expression>;
+
         [[nodiscard]] auto evaluate(std::weak_ptr<target> target, const std::vector<lexeme>& arguments = {}, const std::unordered_map<std::string, kdl::lexeme>& vars = {}) const -> lexeme;
 
+        /**
+         * Evaluate the expression as a function call from another compiled expression. Arguments are passed as
+         * pre-decoded values, and the caller's variables are not visible to the function.
+         */
+        [[nodiscard]] auto call(const std::shared_ptr<target>& target, const kdl_value *arguments, std::size_t count) const -> kdl_value;
+
+        /**
+         * The compiled form of the expression. The expression is compiled the first time that it is required.
+         */
+        [[nodiscard]] auto bytecode() const -> const kdl_bytecode&;
+
+        [[nodiscard]] auto lexemes() const -> const std::vector<lexeme>&;
+
+        /**
+         * Determine if the result of the expression depends only upon the arguments that it is given. The results
+         * of pure expressions are memoised, keyed by their arguments.
+         */
+        [[nodiscard]] auto is_pure(const target& target) const -> bool;
+
+        /**
+         * Reuse the result of the first evaluation of the expression for any later evaluations. This only applies
+         * whilst the expression is pure and does not refer to any arguments. Nothing is evaluated until the first
+         * call, so an expression that is never used can not fail.
+         */
+        auto allow_folding() -> void;
+
     private:
+        struct memo_argument
+        {
+            enum lexeme::type type;
+            std::int64_t number;
+            std::string text;
+        };
+
+        struct memo_entry
+        {
+            std::vector<memo_argument> arguments;
+            kdl_value result;
+        };
+
+        /**
+         * The most distinct argument lists that are remembered for an expression. Once this is reached the memo is
+         * discarded and starts again, rather than growing with every new combination of arguments.
+         */
+        static constexpr std::size_t memo_limit { 4096 };
+
         std::vector<lexeme> m_lexemes;
+        mutable std::shared_ptr<const kdl_bytecode> m_bytecode;
+        mutable std::optional<bool> m_pure;
+        mutable std::uint64_t m_purity_generation { 0 };
+        mutable bool m_checking_purity { false };
+        bool m_foldable { false };
+        mutable std::optional<kdl_value> m_folded;
+        mutable std::unordered_multimap<std::size_t, memo_entry> m_memo;
+
+        auto invoke(const std::shared_ptr<target>& target, const kdl_value *arguments, std::size_t count, const std::unordered_map<std::string, kdl::lexeme> *vars) const -> kdl_value;
+
+        auto verify(const std::shared_ptr<target>& target, const lexeme& result, const std::vector<lexeme>& arguments, const std::unordered_map<std::string, kdl::lexeme>& vars) const -> void;
     };
 }
\ No newline at end of file
@@ -0,0 +1,316 @@
+// Copyright (c) 2022 Tom Hancocks
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include "diagnostic/fatal.hpp"
+#include "target/new/module_encoding.hpp"
+#include "kdl_version.hpp"
+
+// MARK: - Helpers
+
+namespace
+{
+    constexpr std::size_t header_size = 28;
+
+    auto module_hash(std::string_view data) -> std::uint64_t
+    {
+        std::uint64_t hash = 14695981039346656037ULL;
+        for (auto c : data) {
+            hash ^= static_cast<std::uint8_t>(c);
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    auto append_u32(std::string& out, std::uint32_t value) -> void
+    {
+        for (auto i = 0; i < 4; ++i) {
+            out.push_back(static_cast<char>((value >> (i * 8)) & 0xFF));
+        }
+    }
+
+    auto append_u64(std::string& out, std::uint64_t value) -> void
+    {
+        append_u32(out, static_cast<std::uint32_t>(value & 0xFFFFFFFF));
+        append_u32(out, static_cast<std::uint32_t>(value >> 32));
+    }
+
+    auto decode_u64(std::string_view data, std::size_t offset, std::size_t size) -> std::uint64_t
+    {
+        std::uint64_t value = 0;
+        for (std::size_t i = 0; i < size; ++i) {
+            value |= static_cast<std::uint64_t>(static_cast<std::uint8_t>(data[offset + i])) << (i * 8);
+        }
+        return value;
+    }
+
+    auto capitalised(std::string text) -> std::string
+    {
+        if (!text.empty()) {
+            text[0] = static_cast<char>(std::toupper(static_cast<unsigned char>(text[0])));
+        }
+        return text;
+    }
+}
+
+// MARK: - Writing
+
+auto kdl::build_target::module_writer::write_u8(std::uint8_t value) -> void
+{
+    m_data.push_back(static_cast<char>(value));
+}
+
+auto kdl::build_target::module_writer::write_u32(std::uint32_t value) -> void
+{
+    append_u32(m_data, value);
+}
+
+auto kdl::build_target::module_writer::write_i32(std::int32_t value) -> void
+{
+    write_u32(static_cast<std::uint32_t>(value));
+}
+
+auto kdl::build_target::module_writer::write_u64(std::uint64_t value) -> void
+{
+    append_u64(m_data, value);
+}
+
+auto kdl::build_target::module_writer::write_i64(std::int64_t value) -> void
+{
+    write_u64(static_cast<std::uint64_t>(value));
+}
+
+auto kdl::build_target::module_writer::write_string(const std::string& value) -> void
+{
+    auto it = m_string_indices.find(value);
+    if (it == m_string_indices.end()) {
+        it = m_string_indices.emplace(value, static_cast<std::uint32_t>(m_strings.size())).first;
+        m_strings.emplace_back(value);
+    }
+    write_u32(it->second);
+}
+
+auto kdl::build_target::module_writer::write_bytes(const std::vector<std::uint8_t>& bytes) -> void
+{
+    write_u64(bytes.size());
+    m_data.append(bytes.begin(), bytes.end());
+}
+
+auto kdl::build_target::module_writer::write_lexeme(const lexeme& lx) -> void
+{
+    auto components = lx.components();
+    write_string(lx.text());
+    write_u8(static_cast<std::uint8_t>(lx.type()));
+    write_u8(components.empty() ? 0 : 1);
+    write_u32(static_cast<std::uint32_t>(lx.line()));
+    write_u32(static_cast<std::uint32_t>(lx.offset()));
+
+    if (!components.empty()) {
+        write_u32(static_cast<std::uint32_t>(components.size()));
+        for (const auto& component : components) {
+            write_string(component);
+        }
+    }
+}
+
+auto kdl::build_target::module_writer::write_lexeme(const std::optional<lexeme>& lx) -> void
+{
+    write_u8(lx.has_value() ? 1 : 0);
+    if (lx.has_value()) {
+        write_lexeme(lx.value());
+    }
+}
+
+auto kdl::build_target::module_writer::finish(const module_format& format) const -> std::string
+{
+    std::string payload;
+    append_u32(payload, static_cast<std::uint32_t>(m_strings.size()));
+    for (const auto& string : m_strings) {
+        append_u32(payload, static_cast<std::uint32_t>(string.size()));
+        payload.append(string);
+    }
+    payload.append(m_data);
+
+    // The encoding of the contents may change between versions of KDL without the format version changing, so the
+    // version of KDL that wrote the file is recorded after the header.
+    std::string_view kdl_version(KDL_VERSION);
+    std::string module(format.magic.begin(), format.magic.end());
+    append_u32(module, format.version);
+    append_u64(module, payload.size());
+    append_u64(module, module_hash(payload));
+    append_u32(module, static_cast<std::uint32_t>(kdl_version.size()));
+    module.append(kdl_version);
+    module.append(payload);
+    return module;
+}
+
+auto kdl::build_target::module_writer::write(const std::string& path, const module_format& format) const -> void
+{
+    auto resolved_path = kdl::file::resolve_tilde(path);
+    kdl::file::create_intermediate(resolved_path);
+
+    auto module = finish(format);
+    std::ofstream out(resolved_path, std::ios::binary | std::ios::trunc);
+    out.write(module.data(), static_cast<std::streamsize>(module.size()));
+    if (!out.good()) {
+        log::fatal_error(lexeme(path, lexeme::string), 1, "Failed to write " + std::string(format.name) + ": " + path);
+    }
+}
+
+// MARK: - Reading
+
+kdl::build_target::module_reader::module_reader(const std::shared_ptr<kdl::file>& file, const module_format& format, const lexeme& reference)
+    : m_reference(reference), m_name(format.name)
+{
+    auto data = file->view();
+    if (data.size() < header_size || std::memcmp(data.data(), format.magic.data(), format.magic.size()) != 0) {
+        log::fatal_error(reference, 1, "Not a " + m_name + ": " + file->path());
+    }
+
+    if (decode_u64(data, format.magic.size(), 4) != format.version) {
+        log::fatal_error(reference, 1, capitalised(m_name) + " was written by an incompatible version of KDL: " + file->path());
+    }
+
+    auto payload_size = decode_u64(data, 8, 8);
+    auto payload_hash = decode_u64(data, 16, 8);
+    auto kdl_version_size = decode_u64(data, 24, 4);
+    if (data.size() < header_size + kdl_version_size) {
+        log::fatal_error(reference, 1, capitalised(m_name) + " is damaged: " + file->path());
+    }
+
+    auto kdl_version = data.substr(header_size, kdl_version_size);
+    if (kdl_version != KDL_VERSION) {
+        log::fatal_error(reference, 1, capitalised(m_name) + " was written by KDL " + std::string(kdl_version) + ", and must be rebuilt for KDL " + KDL_VERSION + ": " + file->path());
+    }
+
+    // Files that are read from disk are terminated with a newline for the benefit of the lexer, so the view may be a
+    // little longer than the module itself.
+    auto payload = data.substr(header_size + kdl_version_size);
+    if (payload.size() < payload_size || module_hash(payload.substr(0, payload_size)) != payload_hash) {
+        log::fatal_error(reference, 1, capitalised(m_name) + " is damaged: " + file->path());
+    }
+
+    m_data = payload.substr(0, payload_size);
+    m_source = lexeme::register_source(file);
+    read_string_table();
+}
+
+auto kdl::build_target::module_reader::read_u8() -> std::uint8_t
+{
+    require(1);
+    return static_cast<std::uint8_t>(m_data[m_pos++]);
+}
+
+auto kdl::build_target::module_reader::read_u32() -> std::uint32_t
+{
+    require(4);
+    auto value = static_cast<std::uint32_t>(decode_u64(m_data, m_pos, 4));
+    m_pos += 4;
+    return value;
+}
+
+auto kdl::build_target::module_reader::read_i32() -> std::int32_t
+{
+    return static_cast<std::int32_t>(read_u32());
+}
+
+auto kdl::build_target::module_reader::read_u64() -> std::uint64_t
+{
+    require(8);
+    auto value = decode_u64(m_data, m_pos, 8);
+    m_pos += 8;
+    return value;
+}
+
+auto kdl::build_target::module_reader::read_i64() -> std::int64_t
+{
+    return static_cast<std::int64_t>(read_u64());
+}
+
+auto kdl::build_target::module_reader::read_string_table() -> void
+{
+    auto count = read_u32();
+    m_strings.reserve(count);
+    for (std::uint32_t i = 0; i < count; ++i) {
+        auto length = read_u32();
+        require(length);
+        m_strings.emplace_back(m_data.substr(m_pos, length));
+        m_pos += length;
+    }
+}
+
+auto kdl::build_target::module_reader::read_string() -> std::string_view
+{
+    auto index = read_u32();
+    if (index >= m_strings.size()) {
+        log::fatal_error(m_reference, 1, capitalised(m_name) + " refers to a string that does not exist.");
+    }
+    return m_strings[index];
+}
+
+auto kdl::build_target::module_reader::read_bytes() -> std::vector<std::uint8_t>
+{
+    auto size = read_u64();
+    require(size);
+    auto bytes = m_data.substr(m_pos, size);
+    m_pos += size;
+    return { bytes.begin(), bytes.end() };
+}
+
+auto kdl::build_target::module_reader::read_lexeme() -> lexeme
+{
+    auto text = read_string();
+    auto type = static_cast<enum lexeme::type>(read_u8());
+    auto has_components = read_u8() != 0;
+    auto line = read_u32();
+    auto offset = read_u32();
+
+    if (has_components) {
+        std::vector<std::string> components(read_u32());
+        for (auto& component : components) {
+            component = read_string();
+        }
+        return { components, type, 0, offset, line, m_source };
+    }
+    return { text, type, 0, offset, line, m_source };
+}
+
+auto kdl::build_target::module_reader::read_optional_lexeme() -> std::optional<lexeme>
+{
+    if (read_u8() == 0) {
+        return {};
+    }
+    return read_lexeme();
+}
+
+auto kdl::build_target::module_reader::remaining() const -> std::size_t
+{
+    return m_data.size() - m_pos;
+}
+
+auto kdl::build_target::module_reader::require(std::size_t count) const -> void
+{
+    if (count > remaining()) {
+        log::fatal_error(m_reference, 1, capitalised(m_name) + " is truncated.");
+    }
+}
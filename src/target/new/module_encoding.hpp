@@ -0,0 +1,125 @@
+// Copyright (c) 2022 Tom Hancocks
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "parser/file.hpp"
+#include "parser/lexeme.hpp"
+
+namespace kdl::build_target
+{
+
+    /**
+     * Identifies a kind of precompiled file, such as a type module or an object file. Each kind has its own magic
+     * number and format version, and a name that is used when reporting problems with the file. Every file also
+     * records the version of KDL that wrote it, and can only be read by that same version.
+     */
+    struct module_format
+    {
+        std::array<char, 4> magic;
+        std::uint32_t version;
+        const char *name;
+    };
+
+    /**
+     * Encodes the contents of a precompiled file. All integers are written in little endian byte order, one byte at
+     * a time, so that the layout does not depend on the host that wrote it.
+     *
+     * Every string is stored once in a table that is placed ahead of the encoded contents, and is referred to by its
+     * index. Blocks of raw data are stored inline.
+     */
+    class module_writer
+    {
+    public:
+        module_writer() = default;
+
+        auto write_u8(std::uint8_t value) -> void;
+        auto write_u32(std::uint32_t value) -> void;
+        auto write_i32(std::int32_t value) -> void;
+        auto write_u64(std::uint64_t value) -> void;
+        auto write_i64(std::int64_t value) -> void;
+        auto write_string(const std::string& value) -> void;
+        auto write_bytes(const std::vector<std::uint8_t>& bytes) -> void;
+        auto write_lexeme(const lexeme& lx) -> void;
+        auto write_lexeme(const std::optional<lexeme>& lx) -> void;
+
+        /**
+         * Produce the final file, consisting of the header, the string table and then the encoded contents.
+         */
+        [[nodiscard]] auto finish(const module_format& format) const -> std::string;
+
+        /**
+         * Write the final file to the specified path, creating any intermediate directories.
+         */
+        auto write(const std::string& path, const module_format& format) const -> void;
+
+    private:
+        std::string m_data;
+        std::vector<std::string> m_strings;
+        std::unordered_map<std::string, std::uint32_t> m_string_indices;
+    };
+
+    /**
+     * Decodes the contents of a precompiled file, directly from the view of the file. The header is checked when
+     * the reader is constructed, and a fatal error is raised against the reference lexeme if the file is of the wrong
+     * kind, was written with a different format version or has been damaged.
+     *
+     * Lexemes read from the file belong to it, but keep the line and offset at which they appeared in their original
+     * source.
+     */
+    class module_reader
+    {
+    public:
+        module_reader(const std::shared_ptr<kdl::file>& file, const module_format& format, const lexeme& reference);
+
+        auto read_u8() -> std::uint8_t;
+        auto read_u32() -> std::uint32_t;
+        auto read_i32() -> std::int32_t;
+        auto read_u64() -> std::uint64_t;
+        auto read_i64() -> std::int64_t;
+        auto read_string() -> std::string_view;
+        auto read_bytes() -> std::vector<std::uint8_t>;
+        auto read_lexeme() -> lexeme;
+        auto read_optional_lexeme() -> std::optional<lexeme>;
+
+        [[nodiscard]] auto remaining() const -> std::size_t;
+
+    private:
+        std::string_view m_data;
+        std::size_t m_pos { 0 };
+        std::vector<std::string_view> m_strings;
+        lexeme::source_id m_source { 0 };
+        lexeme m_reference;
+        std::string m_name;
+
+        auto read_string_table() -> void;
+        auto require(std::size_t count) const -> void;
+    };
+
+}
@@ -0,0 +1,370 @@
+// Copyright (c) 2022 Tom Hancocks
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include "diagnostic/fatal.hpp"
+#include "target/new/object_file.hpp"
+#include "target/target.hpp"
+#include "libGraphite/data/reader.hpp"
+#include "libGraphite/data/writer.hpp"
+
+// MARK: - Compiling
+
+auto kdl::build_target::object_file::compile(const std::shared_ptr<target>& target, const kdl::target *base) -> object_file
+{
+    object_file object;
+    object.m_required_format = target->required_format();
+    object.m_id_allocation_events = target->id_allocation_events();
+    object.m_imports = target->imports();
+
+    for (std::size_t i = 0; i < target->type_container_count(); ++i) {
+        const auto& container = target->type_container_at(static_cast<int>(i));
+        if (!base || !base->has_type_named(container.name())) {
+            object.m_types.add_type_container(container);
+        }
+    }
+
+    // Constants and functions are held by name in the target, so sort them to keep the object the same between
+    // builds of the same source.
+    for (const auto& it : target->all_global_variables()) {
+        auto name = symbol_table::shared().intern(it.first);
+        auto is_mutable = target->is_global_variable_mutable(name);
+        if (base) {
+            auto inherited = base->global_value(name);
+            if (inherited && inherited->to_lexeme().is(it.second) && base->is_global_variable_mutable(name) == is_mutable) {
+                continue;
+            }
+        }
+        object.m_constants.emplace_back(constant { it.first, it.second, is_mutable });
+    }
+    std::sort(object.m_constants.begin(), object.m_constants.end(), [] (const auto& lhs, const auto& rhs) {
+        return lhs.name < rhs.name;
+    });
+
+    for (const auto& it : target->all_function_expressions()) {
+        if (!base || !base->function_expression(it.first)) {
+            object.m_functions.emplace_back(function { it.first, it.second->lexemes() });
+        }
+    }
+    std::sort(object.m_functions.begin(), object.m_functions.end(), [] (const auto& lhs, const auto& rhs) {
+        return lhs.name < rhs.name;
+    });
+
+    const auto& declared_resources = target->resources();
+    for (std::size_t i = 0; i < declared_resources.size(); ++i) {
+        auto constructor = declared_resources[i];
+        std::vector<id_relocation> relocations;
+        const auto data = constructor.assemble(&relocations);
+
+        graphite::data::reader reader(&data);
+        auto bytes = reader.read_bytes(reader.size());
+
+        auto attributes = constructor.attributes();
+        resource compiled {
+            constructor.type_code(),
+            constructor.id(),
+            constructor.name(),
+            constructor.has_automatic_id(),
+            { attributes.begin(), attributes.end() },
+            { bytes.begin(), bytes.end() },
+            std::move(relocations),
+            target->resource_import_key(i)
+        };
+        std::sort(compiled.attributes.begin(), compiled.attributes.end());
+        object.m_resources.emplace_back(std::move(compiled));
+    }
+
+    return object;
+}
+
+// MARK: - Linking
+
+auto kdl::build_target::object_file::link(const std::vector<object_file>& objects, const std::shared_ptr<target>& target) -> void
+{
+    // Everything is merged in the order that the objects were given, as if each of the sources had been parsed in
+    // turn. Types and functions keep their earliest definition.
+    auto tracker = target->resource_tracker();
+    auto imported = target->imports();
+    std::unordered_set<std::string> linked_imports(imported.begin(), imported.end());
+    for (const auto& object : objects) {
+        if (object.m_required_format.has_value() && !target->set_required_format(object.m_required_format.value())) {
+            log::fatal_error(lexeme(object.m_path, lexeme::string), 1, "Object file requires a different resource format to the other object files: " + object.m_path);
+        }
+
+        for (const auto& container : object.m_types.type_containers()) {
+            if (!target->has_type_named(container.name())) {
+                target->add_type_container(container);
+            }
+        }
+
+        for (const auto& constant : object.m_constants) {
+            target->set_global_variable(constant.name, constant.value);
+            if (constant.is_mutable) {
+                target->set_global_variable_mutable(constant.name);
+            }
+        }
+
+        for (const auto& function : object.m_functions) {
+            if (!target->function_expression(function.name)) {
+                target->set_function_expression(function.name, std::make_shared<kdl_expression>(function.lexemes));
+            }
+        }
+
+        // Resources that were allocated an id automatically are allocated it again, now that the resources of the
+        // preceding objects are known. Nested resources are always declared before the resource that refers to
+        // them, so their final id is known by the time that the reference is reached.
+        std::map<std::pair<std::string, std::int64_t>, std::int64_t> allocated_ids;
+        auto event = object.m_id_allocation_events.begin();
+        for (std::size_t i = 0; i < object.m_resources.size(); ++i) {
+            // Changes to how ids are allocated only apply to the resources that were declared after them.
+            for (; event != object.m_id_allocation_events.end() && event->resource_index <= i; ++event) {
+                target->apply_id_allocation_event(*event);
+            }
+
+            // The resources of a source that an earlier object has already imported have already been linked.
+            const auto& resource = object.m_resources[i];
+            if (!resource.source.empty() && linked_imports.find(resource.source) != linked_imports.end()) {
+                continue;
+            }
+
+            auto data = resource.data;
+            for (const auto& relocation : resource.relocations) {
+                auto it = allocated_ids.find({ relocation.type_code, relocation.id });
+                if (it == allocated_ids.end() || it->second == relocation.id) {
+                    continue;
+                }
+
+                if (relocation.offset + relocation.width > data.size()) {
+                    log::fatal_error(lexeme(object.m_path, lexeme::string), 1, "Object file is damaged: " + object.m_path);
+                }
+
+                // Resource data is always big endian.
+                auto value = static_cast<std::uint64_t>(it->second);
+                for (std::size_t n = 0; n < relocation.width; ++n) {
+                    data[relocation.offset + n] = static_cast<std::uint8_t>(value >> ((relocation.width - n - 1) * 8));
+                }
+            }
+
+            // The id is only allocated once the references have been updated, as a provisional id may have been
+            // shared with one of the nested resources.
+            auto id = resource.id;
+            if (resource.automatic_id) {
+                id = tracker->next_available_id(resource.type_code);
+                allocated_ids[{ resource.type_code, resource.id }] = id;
+            }
+
+            graphite::data::writer writer(graphite::data::byte_order::msb);
+            writer.write_bytes(data);
+
+            resource_constructor linked(target, id, resource.type_code, resource.name, *writer.data());
+            linked.set_attributes({ resource.attributes.begin(), resource.attributes.end() });
+            target->add_resource(linked);
+        }
+
+        for (; event != object.m_id_allocation_events.end(); ++event) {
+            target->apply_id_allocation_event(*event);
+        }
+
+        linked_imports.insert(object.m_imports.begin(), object.m_imports.end());
+    }
+}
+
+// MARK: - Writing
+
+auto kdl::build_target::object_file::write(const std::string& path) const -> void
+{
+    module_writer writer;
+    writer.write_u8(m_required_format.has_value() ? static_cast<std::uint8_t>(m_required_format.value()) + 1 : 0);
+    writer.write_u32(static_cast<std::uint32_t>(m_id_allocation_events.size()));
+    for (const auto& event : m_id_allocation_events) {
+        writer.write_u64(event.resource_index);
+        writer.write_u8(static_cast<std::uint8_t>(event.type));
+        writer.write_u8(static_cast<std::uint8_t>(event.policy));
+        writer.write_string(event.type_code);
+        writer.write_i64(event.first);
+        writer.write_i64(event.last);
+    }
+
+    writer.write_u32(static_cast<std::uint32_t>(m_imports.size()));
+    for (const auto& import : m_imports) {
+        writer.write_string(import);
+    }
+
+    m_types.encode(writer);
+
+    writer.write_u32(static_cast<std::uint32_t>(m_constants.size()));
+    for (const auto& constant : m_constants) {
+        writer.write_string(constant.name);
+        writer.write_lexeme(constant.value);
+        writer.write_u8(constant.is_mutable ? 1 : 0);
+    }
+
+    writer.write_u32(static_cast<std::uint32_t>(m_functions.size()));
+    for (const auto& function : m_functions) {
+        writer.write_string(function.name);
+        writer.write_u32(static_cast<std::uint32_t>(function.lexemes.size()));
+        for (const auto& lx : function.lexemes) {
+            writer.write_lexeme(lx);
+        }
+    }
+
+    writer.write_u32(static_cast<std::uint32_t>(m_resources.size()));
+    for (const auto& resource : m_resources) {
+        writer.write_string(resource.type_code);
+        writer.write_i64(resource.id);
+        writer.write_string(resource.name);
+        writer.write_u8(resource.automatic_id ? 1 : 0);
+        writer.write_string(resource.source);
+
+        writer.write_u32(static_cast<std::uint32_t>(resource.attributes.size()));
+        for (const auto& attribute : resource.attributes) {
+            writer.write_string(attribute.first);
+            writer.write_string(attribute.second);
+        }
+
+        writer.write_bytes(resource.data);
+
+        writer.write_u32(static_cast<std::uint32_t>(resource.relocations.size()));
+        for (const auto& relocation : resource.relocations) {
+            writer.write_u64(relocation.offset);
+            writer.write_u8(static_cast<std::uint8_t>(relocation.width));
+            writer.write_string(relocation.type_code);
+            writer.write_i64(relocation.id);
+        }
+    }
+
+    writer.write(path, format);
+}
+
+// MARK: - Reading
+
+auto kdl::build_target::object_file::read(const std::shared_ptr<kdl::file>& file, const lexeme& reference) -> object_file
+{
+    module_reader reader(file, format, reference);
+
+    object_file object;
+    object.m_path = file->path();
+
+    if (auto required_format = reader.read_u8()) {
+        object.m_required_format = static_cast<enum graphite::rsrc::file::format>(required_format - 1);
+    }
+
+    auto event_count = reader.read_u32();
+    for (std::uint32_t i = 0; i < event_count; ++i) {
+        resource_tracking::allocation_event event;
+        event.resource_index = reader.read_u64();
+        event.type = static_cast<resource_tracking::allocation_event::event_type>(reader.read_u8());
+        event.policy = static_cast<resource_tracking::table::allocation_policy>(reader.read_u8());
+        event.type_code = reader.read_string();
+        event.first = reader.read_i64();
+        event.last = reader.read_i64();
+        object.m_id_allocation_events.emplace_back(std::move(event));
+    }
+
+    auto import_count = reader.read_u32();
+    for (std::uint32_t i = 0; i < import_count; ++i) {
+        object.m_imports.emplace_back(reader.read_string());
+    }
+
+    object.m_types = type_module::decode(reader);
+
+    auto constant_count = reader.read_u32();
+    for (std::uint32_t i = 0; i < constant_count; ++i) {
+        auto name = std::string(reader.read_string());
+        auto value = reader.read_lexeme();
+        object.m_constants.emplace_back(constant { name, value, reader.read_u8() != 0 });
+    }
+
+    auto function_count = reader.read_u32();
+    for (std::uint32_t i = 0; i < function_count; ++i) {
+        function decoded { std::string(reader.read_string()), {} };
+        auto lexeme_count = reader.read_u32();
+        decoded.lexemes.reserve(lexeme_count);
+        for (std::uint32_t n = 0; n < lexeme_count; ++n) {
+            decoded.lexemes.emplace_back(reader.read_lexeme());
+        }
+        object.m_functions.emplace_back(std::move(decoded));
+    }
+
+    auto resource_count = reader.read_u32();
+    object.m_resources.reserve(resource_count);
+    for (std::uint32_t i = 0; i < resource_count; ++i) {
+        resource decoded;
+        decoded.type_code = reader.read_string();
+        decoded.id = reader.read_i64();
+        decoded.name = reader.read_string();
+        decoded.automatic_id = reader.read_u8() != 0;
+        decoded.source = reader.read_string();
+
+        auto attribute_count = reader.read_u32();
+        for (std::uint32_t n = 0; n < attribute_count; ++n) {
+            auto attribute_name = std::string(reader.read_string());
+            decoded.attributes.emplace_back(attribute_name, reader.read_string());
+        }
+
+        decoded.data = reader.read_bytes();
+
+        auto relocation_count = reader.read_u32();
+        for (std::uint32_t n = 0; n < relocation_count; ++n) {
+            id_relocation relocation {};
+            relocation.offset = reader.read_u64();
+            relocation.width = reader.read_u8();
+            relocation.type_code = reader.read_string();
+            relocation.id = reader.read_i64();
+            decoded.relocations.emplace_back(std::move(relocation));
+        }
+
+        object.m_resources.emplace_back(std::move(decoded));
+    }
+
+    return object;
+}
+
+auto kdl::build_target::object_file::is_object_path(const std::string& path) -> bool
+{
+    std::string_view suffix(extension);
+    return path.size() > suffix.size() && path.compare(path.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// MARK: - Accessors
+
+auto kdl::build_target::object_file::types() const -> const type_module&
+{
+    return m_types;
+}
+
+auto kdl::build_target::object_file::constants() const -> const std::vector<constant>&
+{
+    return m_constants;
+}
+
+auto kdl::build_target::object_file::functions() const -> const std::vector<function>&
+{
+    return m_functions;
+}
+
+auto kdl::build_target::object_file::resources() const -> const std::vector<resource>&
+{
+    return m_resources;
+}
@@ -0,0 +1,139 @@
+// Copyright (c) 2022 Tom Hancocks
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+#include <libGraphite/rsrc/file.hpp>
+#include "parser/file.hpp"
+#include "parser/lexeme.hpp"
+#include "target/new/module_encoding.hpp"
+#include "target/new/resource.hpp"
+#include "target/new/type_module.hpp"
+#include "target/track/resource_tracking.hpp"
+
+namespace kdl
+{
+    class target;
+}
+
+namespace kdl::build_target
+{
+
+    /**
+     * An object file is the result of compiling a single source file on its own. It holds the assembled data of each
+     * resource that was declared, along with the types, constants and functions that were defined, so that they can
+     * be linked with other object files into a single resource file without parsing any of the sources again.
+     *
+     * Resources declared with #auto are given an id when they are compiled, but that id is only provisional. When the
+     * objects are linked, they are allocated their final id in the same way that they would have been had all of the
+     * sources been built together, and references to them from nested resource declarations are updated to match.
+     * Any change to the allocation policy or reserved ids is made between the same two resources as in the source.
+     *
+     * Each resource also records the source file that declared it, and the object records every source that it
+     * imported. A source imported by more than one object only has its resources linked from the first of them, just
+     * as it would only have been imported once had all of the sources been built together.
+     */
+    class object_file
+    {
+    public:
+        static constexpr std::uint32_t format_version = 4;
+        static constexpr const char *extension = ".kdlo";
+        static constexpr module_format format { { 'K', 'D', 'L', 'O' }, format_version, "object file" };
+
+        struct constant
+        {
+            std::string name;
+            lexeme value;
+            bool is_mutable;
+        };
+
+        struct function
+        {
+            std::string name;
+            std::vector<lexeme> lexemes;
+        };
+
+        struct resource
+        {
+            std::string type_code;
+            std::int64_t id;
+            std::string name;
+            bool automatic_id;
+            std::vector<std::pair<std::string, std::string>> attributes;
+            std::vector<std::uint8_t> data;
+            std::vector<id_relocation> relocations;
+            std::string source;
+        };
+
+        object_file() = default;
+
+        /**
+         * Produce an object from everything that has been defined and declared in the target, assembling each of
+         * the declared resources. If the target was forked from a base target, then the types, constants and
+         * functions that it inherited unchanged from the base are left out.
+         */
+        static auto compile(const std::shared_ptr<target>& target, const kdl::target *base = nullptr) -> object_file;
+
+        /**
+         * Link the contents of each of the objects into the target, in the order that they are given. The resources
+         * are added to the target, ready for it to be saved.
+         */
+        static auto link(const std::vector<object_file>& objects, const std::shared_ptr<target>& target) -> void;
+
+        /**
+         * Write the object to the specified path, creating any intermediate directories.
+         */
+        auto write(const std::string& path) const -> void;
+
+        /**
+         * Read an object from a file. If the file is not an object, was written with a different format version or
+         * has been damaged, then a fatal error is raised against the reference lexeme.
+         */
+        static auto read(const std::shared_ptr<kdl::file>& file, const lexeme& reference) -> object_file;
+
+        /**
+         * Check if the specified path refers to an object file.
+         */
+        static auto is_object_path(const std::string& path) -> bool;
+
+        [[nodiscard]] auto types() const -> const type_module&;
+        [[nodiscard]] auto constants() const -> const std::vector<constant>&;
+        [[nodiscard]] auto functions() const -> const std::vector<function>&;
+        [[nodiscard]] auto resources() const -> const std::vector<resource>&;
+
+    private:
+        std::string m_path;
+        std::optional<enum graphite::rsrc::file::format> m_required_format;
+        std::vector<resource_tracking::allocation_event> m_id_allocation_events;
+        std::vector<std::string> m_imports;
+        type_module m_types;
+        std::vector<constant> m_constants;
+        std::vector<function> m_functions;
+        std::vector<resource> m_resources;
+    };
+
+}
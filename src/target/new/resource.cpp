@@ -20,44 +20,52 @@
 
 #include <limits>
 #include <utility>
+#include "kdl_version.hpp"
 #include "target/new/resource.hpp"
+#include "target/new/assembly_cache.hpp"
+#include "libGraphite/data/reader.hpp"
 #include "diagnostic/fatal.hpp"
 #include "target/target.hpp"
 
 // MARK: - Construction
 
-kdl::build_target::resource_constructor::resource_constructor(std::shared_ptr<target> target, graphite::rsrc::resource::identifier id, const std::string &code, const std::string &name, class type_template tmpl)
+kdl::build_target::resource_constructor::resource_constructor(std::shared_ptr<target> target, graphite::rsrc::resource::identifier id, const std::string &code, const std::string &name, std::shared_ptr<const class type_template> tmpl)
     : m_type_code(code), m_id(id), m_name(name), m_tmpl(std::move(tmpl)), m_target(target)
 {
     construct_root_value_container();
 }
 
-kdl::build_target::resource_constructor::resource_constructor(std::shared_ptr<target> target, graphite::rsrc::resource::identifier id, const std::string &code, const std::string &name, const std::string &contents)
-    : m_type_code(code), m_id(id), m_name(name), m_target(target)
+kdl::build_target::resource_constructor::resource_constructor(std::shared_ptr<target> target, graphite::rsrc::resource::identifier id, const std::string &code, const std::string &name, std::string_view contents)
+    : m_type_code(code), m_id(id), m_name(name), m_tmpl(data_template(binary_type::CSTR)), m_target(target)
 {
     construct_root_value_container();
 
-    // We're pulling contents directly, so we need to synthesize a template to represent a singular CSTR field.
-    lexeme data_lx("data", lexeme::identifier);
-    type_template::binary_field data_field(data_lx, binary_type::CSTR);
-    m_tmpl.add_binary_field(data_field);
-
     // Add the contents to the field.
-    write("data", std::make_tuple(contents.size(), contents));
+    write("data", std::make_tuple(contents.size(), std::string(contents)));
 }
 
 kdl::build_target::resource_constructor::resource_constructor(std::shared_ptr<target> target, graphite::rsrc::resource::identifier id, const std::string &code, const std::string &name, const graphite::data::block &data)
-    : m_type_code(code), m_id(id), m_name(name), m_target(target)
+    : m_type_code(code), m_id(id), m_name(name), m_tmpl(data_template(binary_type::HEXD)), m_target(target)
 {
     construct_root_value_container();
 
-    // We're pulling contents directly, so we need to synthesize a template to represent a singular HEXD field.
-    lexeme data_lx("data", lexeme::identifier);
-    type_template::binary_field data_field(data_lx, binary_type::HEXD);
-    m_tmpl.add_binary_field(data_field);
-
     // Add the contents to the field.
-    write("data", std::make_tuple(data.size(), data));
+    write("data", data);
+}
+
+auto kdl::build_target::resource_constructor::data_template(enum binary_type type) -> std::shared_ptr<const class type_template>
+{
+    // We're pulling contents directly, so we need a template to represent a singular field of the raw data. These
+    // are the same for every resource, so they are only synthesized once.
+    static const auto make_template = [] (enum binary_type type) {
+        auto tmpl = std::make_shared<class type_template>();
+        tmpl->add_binary_field(type_template::binary_field(lexeme("data", lexeme::identifier), type));
+        return std::shared_ptr<const class type_template>(std::move(tmpl));
+    };
+    static const auto cstr_template = make_template(binary_type::CSTR);
+    static const auto hexd_template = make_template(binary_type::HEXD);
+
+    return (type == binary_type::CSTR) ? cstr_template : hexd_template;
 }
 
 // MARK: - Accessors
@@ -77,6 +85,16 @@ auto kdl::build_target::resource_constructor::name() const -> const std::string
     return m_name;
 }
 
+auto kdl::build_target::resource_constructor::set_automatic_id(bool automatic) -> void
+{
+    m_automatic_id = automatic;
+}
+
+auto kdl::build_target::resource_constructor::has_automatic_id() const -> bool
+{
+    return m_automatic_id;
+}
+
 auto kdl::build_target::resource_constructor::attributes() const -> std::unordered_map<std::string, std::string>
 {
     return m_attributes;
@@ -94,15 +112,14 @@ auto kdl::build_target::resource_constructor::set_attribute(const std::string &n
 
 auto kdl::build_target::resource_constructor::type_template() const -> const class type_template&
 {
-    return m_tmpl;
+    return *m_tmpl;
 }
 
 // MARK: - Field Counts
 
 auto kdl::build_target::resource_constructor::field_use_count(const lexeme &field) const -> std::int32_t
 {
-    auto list = std::any_cast<std::vector<value_container *>>(m_values->value);
-    for (auto container : list) {
+    for (auto container : m_values->children) {
         return container->field_count;
     }
     return 0;
@@ -121,8 +138,7 @@ auto kdl::build_target::resource_constructor::acquire_field(const lexeme &field,
 
 auto kdl::build_target::resource_constructor::reset_acquisition_locks() -> void
 {
-    auto list = std::any_cast<std::vector<value_container *>>(m_values->value);
-    for (auto container : list) {
+    for (auto container : m_values->children) {
         container->field_count = 0;
     }
 }
@@ -131,65 +147,58 @@ auto kdl::build_target::resource_constructor::reset_acquisition_locks() -> void
 
 auto kdl::build_target::resource_constructor::construct_root_value_container() -> void
 {
-    m_values = new value_container();
-    m_values->type = value_type::list;
-    m_values->value = std::vector<value_container *>();
+    m_values = make_value_container(lexeme("", lexeme::identifier), value_type::list);
     m_values->field_count = 1;
 }
 
+auto kdl::build_target::resource_constructor::make_value_container(const lexeme &name, enum value_type type) -> value_container *
+{
+    // Containers are owned by the arena of the resource, and are never moved once created. This allows the tree
+    // to be built from plain pointers without any container needing to be individually freed.
+    return &m_arena->emplace_back(name, type);
+}
+
 auto kdl::build_target::resource_constructor::value_container_at(const lexeme &field) -> value_container *
 {
-    return value_container_at(field.text(), m_values);
+    return child_container_named(field, m_values);
 }
 
 auto kdl::build_target::resource_constructor::value_container_at(const std::string &field_name, value_container *container) -> value_container *
 {
-    auto vc = container ?: (m_pushed_container ?: m_values);
-    auto list = std::any_cast<std::vector<value_container *>>(vc->value);
-    for (auto it : list) {
-        if (it->name == field_name) {
-            return it;
-        }
+    return child_container_named(lexeme(field_name, lexeme::identifier), container ?: (m_pushed_container ?: m_values));
+}
+
+auto kdl::build_target::resource_constructor::child_container_named(const lexeme &field, value_container *container) -> value_container *
+{
+    auto it = container->child_indices.find(field.symbol());
+    if (it != container->child_indices.end()) {
+        return it->second;
     }
 
     // If we reach this point, then we didn't find the value container, so we need to create it.
-    auto sub_container = new value_container();
-    sub_container->field_count = 0;
-    sub_container->type = value_type::single;
+    value_container *sub_container = nullptr;
 
-    if (m_tmpl.has_binary_field_named(field_name)) {
-        auto bin_field = m_tmpl.binary_field_named(field_name);
-        sub_container->name = bin_field.label.text();
-
-        if (bin_field.type == binary_type::OCNT) {
-            sub_container->type = value_type::list;
-            sub_container->value = std::vector<value_container *>();
-        }
+    if (m_tmpl->has_binary_field_named(field)) {
+        const auto& bin_field = m_tmpl->binary_field_named(field);
+        auto type = (bin_field.type == binary_type::OCNT) ? value_type::list : value_type::single;
+        sub_container = make_value_container(bin_field.label, type);
     }
     else /* TODO: Check if this is a repeated field */ {
-        sub_container->name = field_name;
-        sub_container->type = value_type::list;
-        sub_container->value = std::vector<value_container *>();
+        sub_container = make_value_container(field, value_type::list);
     }
 
-    list.emplace_back(sub_container);
-    vc->value = list;
+    container->children.emplace_back(sub_container);
+    container->child_indices.emplace(field.symbol(), sub_container);
 
     return sub_container;
 }
 
-auto kdl::build_target::resource_constructor::const_value_container_at(const std::string &field_name, value_container *container) const -> value_container *
+auto kdl::build_target::resource_constructor::const_value_container_at(const lexeme &field, value_container *container) const -> value_container *
 {
     auto vc = container ?: (m_pushed_container ?: m_values);
 
-    auto list = std::any_cast<std::vector<value_container *>>(vc->value);
-    for (auto it : list) {
-        if (it->name == field_name) {
-            return it;
-        }
-    }
-
-    return nullptr;
+    auto it = vc->child_indices.find(field.symbol());
+    return (it == vc->child_indices.end()) ? nullptr : it->second;
 }
 
 // MARK: - Lists
@@ -198,16 +207,9 @@ auto kdl::build_target::resource_constructor::add_list_element(const lexeme &fie
 {
     auto container = value_container_at(field);
     if (container->type == value_type::list) {
-        auto list = std::any_cast<std::vector<value_container *>>(container->value);
-
-        auto child = new value_container();
-        child->type = value_type::list;
-        child->field_count = 0;
-        child->name = field.text() + "Child" + std::to_string(list.size());
-        child->value = std::vector<value_container *>();
-
-        list.emplace_back(child);
-        container->value = list;
+        // List elements are only ever reached by walking the list, so they are not added to the name index.
+        auto child = make_value_container(field, value_type::list);
+        container->children.emplace_back(child);
 
         m_pushed_container = child;
         callback(this);
@@ -215,87 +217,130 @@ auto kdl::build_target::resource_constructor::add_list_element(const lexeme &fie
     }
 }
 
+// MARK: - Copying
+
+auto kdl::build_target::resource_constructor::copy_values(const resource_constructor &source) -> void
+{
+    // The copied containers are placed in a fresh arena so that the two resources never share any of their values.
+    m_arena = std::make_shared<std::deque<value_container>>();
+    m_pushed_container = nullptr;
+    m_values = copy_value_container(source.m_values);
+}
+
+auto kdl::build_target::resource_constructor::copy_value_container(const value_container *source) -> value_container *
+{
+    auto container = make_value_container(source->name, source->type);
+    container->value = source->value;
+    container->field_count = source->field_count;
+    container->automatic_reference = source->automatic_reference;
+    container->children.reserve(source->children.size());
+
+    for (auto child : source->children) {
+        auto copy = copy_value_container(child);
+        container->children.emplace_back(copy);
+
+        // List elements are not indexed by name, so only children that are indexed are added to the new index.
+        auto it = source->child_indices.find(child->name.symbol());
+        if (it != source->child_indices.end() && it->second == child) {
+            container->child_indices.emplace(it->first, copy);
+        }
+    }
+
+    return container;
+}
+
 // MARK: - Values
 
-auto kdl::build_target::resource_constructor::write(const std::string &field, std::any value) -> void
+auto kdl::build_target::resource_constructor::write(const std::string &field, stored_value value) -> void
 {
-    auto container = value_container_at(field);
+    write(lexeme(field, lexeme::identifier), std::move(value));
+}
+
+auto kdl::build_target::resource_constructor::write(const lexeme &field, stored_value value) -> void
+{
+    auto container = child_container_named(field, m_pushed_container ?: m_values);
     container->value = std::move(value);
 }
 
 auto kdl::build_target::resource_constructor::write_byte(const type_field &field, const type_field_value &field_value, std::uint8_t value) -> void
 {
-    write(field_value.extended_name(available_name_extensions(field)).text(), value);
+    write(field_value.extended_name(field_number(field)), value);
 }
 
 auto kdl::build_target::resource_constructor::write_short(const type_field &field, const type_field_value &field_value, std::uint16_t value) -> void
 {
-    write(field_value.extended_name(available_name_extensions(field)).text(), value);
+    write(field_value.extended_name(field_number(field)), value);
 }
 
 auto kdl::build_target::resource_constructor::write_long(const type_field &field, const type_field_value &field_value, std::uint32_t value) -> void
 {
-    write(field_value.extended_name(available_name_extensions(field)).text(), value);
+    write(field_value.extended_name(field_number(field)), value);
 }
 
 auto kdl::build_target::resource_constructor::write_quad(const type_field &field, const type_field_value &field_value, std::uint64_t value) -> void
 {
-    write(field_value.extended_name(available_name_extensions(field)).text(), value);
+    write(field_value.extended_name(field_number(field)), value);
 }
 
 auto kdl::build_target::resource_constructor::write_signed_byte(const type_field &field, const type_field_value &field_value, std::int8_t value) -> void
 {
-    write(field_value.extended_name(available_name_extensions(field)).text(), value);
+    write(field_value.extended_name(field_number(field)), value);
 }
 
 auto kdl::build_target::resource_constructor::write_signed_short(const type_field &field, const type_field_value &field_value, std::int16_t value) -> void
 {
-    write(field_value.extended_name(available_name_extensions(field)).text(), value);
+    write(field_value.extended_name(field_number(field)), value);
 }
 
 auto kdl::build_target::resource_constructor::write_signed_long(const type_field &field, const type_field_value &field_value, std::int32_t value) -> void
 {
-    write(field_value.extended_name(available_name_extensions(field)).text(), value);
+    write(field_value.extended_name(field_number(field)), value);
 }
 
 auto kdl::build_target::resource_constructor::write_signed_quad(const type_field &field, const type_field_value &field_value, std::int64_t value) -> void
 {
-    write(field_value.extended_name(available_name_extensions(field)).text(), value);
+    write(field_value.extended_name(field_number(field)), value);
 }
 
 auto kdl::build_target::resource_constructor::write_pstr(const type_field &field, const type_field_value &field_value, const std::string &value, std::size_t len) -> void
 {
-    write(field_value.extended_name(available_name_extensions(field)).text(), std::tuple(len, value));
+    write(field_value.extended_name(field_number(field)), std::tuple(len, value));
 }
 
 auto kdl::build_target::resource_constructor::write_cstr(const type_field &field, const type_field_value &field_value, const std::string &value, std::size_t len) -> void
 {
-    write(field_value.extended_name(available_name_extensions(field)).text(), std::tuple(len, value));
+    write(field_value.extended_name(field_number(field)), std::tuple(len, value));
 }
 
 auto kdl::build_target::resource_constructor::write_data(const type_field &field, const type_field_value &field_value, const std::vector<char> &data) -> void
 {
-    write(field_value.extended_name(available_name_extensions(field)).text(), data);
+    write(field_value.extended_name(field_number(field)), data);
 }
 
 auto kdl::build_target::resource_constructor::write_data(const type_field &field, const type_field_value &field_value, const std::vector<std::uint8_t> &data) -> void
 {
-    write(field_value.extended_name(available_name_extensions(field)).text(), data);
+    write(field_value.extended_name(field_number(field)), data);
 }
 
 auto kdl::build_target::resource_constructor::write_data(const type_field &field, const type_field_value &field_value, const graphite::data::block &data) -> void
 {
-    write(field_value.extended_name(available_name_extensions(field)).text(), data);
+    write(field_value.extended_name(field_number(field)), data);
+}
+
+auto kdl::build_target::resource_constructor::write_data(const type_field &field, const type_field_value &field_value, std::shared_ptr<const deferred_data> data) -> void
+{
+    write(field_value.extended_name(field_number(field)), std::move(data));
 }
 
 auto kdl::build_target::resource_constructor::write_rect(const type_field &field, const type_field_value &field_value, std::int16_t t, std::int16_t l, std::int16_t b, std::int16_t r) -> void
 {
-    write(field_value.extended_name(available_name_extensions(field)).text(), std::tuple(t, l, b, r));
+    write(field_value.extended_name(field_number(field)), std::tuple(t, l, b, r));
 }
 
 auto kdl::build_target::resource_constructor::write_resource_reference(const type_field &field, const type_field_value &field_value, const lexeme& ref) -> void
 {
-    if (m_target->is_extended_format()) {
+    auto target = m_target.lock();
+    if (target && target->is_extended_format()) {
         auto components = ref.components();
 
         std::uint8_t reference_flags = 0;
@@ -308,8 +353,8 @@ auto kdl::build_target::resource_constructor::write_resource_reference(const typ
                 auto component_value = components[i];
 
                 // Is this a known type or a namespace?
-                if (m_target->has_type_named(component_value)) {
-                    type_name_value = m_target->type_container_named(component_value).code();
+                if (auto type_container = target->find_type_container(component_value)) {
+                    type_name_value = type_container->code();
                     reference_flags |= 0x2; // Has Type
                 }
                 else {
@@ -319,31 +364,35 @@ auto kdl::build_target::resource_constructor::write_resource_reference(const typ
             }
         }
 
-        write(field_value.extended_name(available_name_extensions(field)).text(), std::tuple(
+        write(field_value.extended_name(field_number(field)), std::tuple(
             reference_flags, namespace_value, type_name_value, ref.value<std::int64_t>()
         ));
     }
     else {
-        write(field_value.extended_name(available_name_extensions(field)).text(), ref.value<std::int16_t>());
+        write(field_value.extended_name(field_number(field)), ref.value<std::int16_t>());
     }
 }
 
+auto kdl::build_target::resource_constructor::mark_automatic_reference(const type_field &field, const type_field_value &field_value, const std::string& type_code) -> void
+{
+    auto container = child_container_named(field_value.extended_name(field_number(field)), m_pushed_container ?: m_values);
+    container->automatic_reference = symbol_table::shared().intern(type_code);
+}
+
 // MARK: - Supporting
 
-auto kdl::build_target::resource_constructor::available_name_extensions(const type_field &field) const -> std::unordered_map<std::string, lexeme>
+auto kdl::build_target::resource_constructor::field_number(const type_field &field) const -> std::optional<std::int32_t>
 {
-    std::unordered_map<std::string, lexeme> vars;
-
     auto field_name = field.name();
     if (field.has_repeatable_count_field()) {
         field_name = field.repeatable_count_field();
     }
 
-    if (auto container = const_value_container_at(field_name.text())) {
-        vars.emplace("FieldNumber", lexeme(std::to_string(container->field_count), lexeme::integer));
+    if (auto container = const_value_container_at(field_name)) {
+        return container->field_count;
     }
 
-    return vars;
+    return {};
 }
 
 auto kdl::build_target::resource_constructor::synthesize_variables(value_container *container) const -> std::unordered_map<std::string, lexeme>
@@ -353,54 +402,53 @@ auto kdl::build_target::resource_constructor::synthesize_variables(value_contain
     vars.emplace("id", lexeme(std::to_string(m_id), lexeme::res_id));
     vars.emplace("name", lexeme(m_name, lexeme::string));
 
-    auto list = std::any_cast<std::vector<value_container *>>((container ?: m_values)->value);
-    for (auto sub_container : list) {
+    for (auto sub_container : (container ?: m_values)->children) {
         if (sub_container->type == value_type::list) {
             auto result = synthesize_variables(sub_container);
             vars.insert(result.begin(), result.end());
         }
         else {
-            auto bin_field = m_tmpl.binary_field_named(sub_container->name);
+            const auto& bin_field = m_tmpl->binary_field_named(sub_container->name);
             auto field_name = bin_field.label.text();
 
             switch (bin_field.type & ~0xFFFUL) {
                 case build_target::HBYT: {
-                    vars.emplace(field_name, lexeme(std::to_string(std::any_cast<std::uint8_t>(sub_container->value)), lexeme::integer));
+                    vars.emplace(field_name, lexeme(std::to_string(std::get<std::uint8_t>(sub_container->value)), lexeme::integer));
                     break;
                 }
                 case build_target::HWRD: {
-                    vars.emplace(field_name, lexeme(std::to_string(std::any_cast<std::uint16_t>(sub_container->value)), lexeme::integer));
+                    vars.emplace(field_name, lexeme(std::to_string(std::get<std::uint16_t>(sub_container->value)), lexeme::integer));
                     break;
                 }
                 case build_target::HLNG: {
-                    vars.emplace(field_name, lexeme(std::to_string(std::any_cast<std::uint32_t>(sub_container->value)), lexeme::integer));
+                    vars.emplace(field_name, lexeme(std::to_string(std::get<std::uint32_t>(sub_container->value)), lexeme::integer));
                     break;
                 }
                 case build_target::HQAD: {
-                    vars.emplace(field_name, lexeme(std::to_string(std::any_cast<std::uint64_t>(sub_container->value)), lexeme::integer));
+                    vars.emplace(field_name, lexeme(std::to_string(std::get<std::uint64_t>(sub_container->value)), lexeme::integer));
                     break;
                 }
                 case build_target::DBYT: {
-                    vars.emplace(field_name, lexeme(std::to_string(std::any_cast<std::int8_t>(sub_container->value)), lexeme::integer));
+                    vars.emplace(field_name, lexeme(std::to_string(std::get<std::int8_t>(sub_container->value)), lexeme::integer));
                     break;
                 }
                 case build_target::DWRD: {
-                    vars.emplace(field_name, lexeme(std::to_string(std::any_cast<std::int16_t>(sub_container->value)), lexeme::integer));
+                    vars.emplace(field_name, lexeme(std::to_string(std::get<std::int16_t>(sub_container->value)), lexeme::integer));
                     break;
                 }
                 case build_target::DLNG: {
-                    vars.emplace(field_name, lexeme(std::to_string(std::any_cast<std::int32_t>(sub_container->value)), lexeme::integer));
+                    vars.emplace(field_name, lexeme(std::to_string(std::get<std::int32_t>(sub_container->value)), lexeme::integer));
                     break;
                 }
                 case build_target::DQAD: {
-                    vars.emplace(field_name, lexeme(std::to_string(std::any_cast<std::int64_t>(sub_container->value)), lexeme::integer));
+                    vars.emplace(field_name, lexeme(std::to_string(std::get<std::int64_t>(sub_container->value)), lexeme::integer));
                     break;
                 }
                 case build_target::PSTR:
                 case build_target::CSTR:
                 case build_target::Cnnn: {
-                    auto str = std::any_cast<std::tuple<std::string, std::size_t>>(sub_container->value);
-                    vars.emplace(field_name, lexeme(std::get<0>(str), lexeme::string));
+                    const auto& str = std::get<std::tuple<std::size_t, std::string>>(sub_container->value);
+                    vars.emplace(field_name, lexeme(std::get<1>(str), lexeme::string));
                     break;
                 }
             }
@@ -410,37 +458,100 @@ auto kdl::build_target::resource_constructor::synthesize_variables(value_contain
     return vars;
 }
 
+auto kdl::build_target::resource_constructor::find_single_value_container(const lexeme &field, value_container *container) const -> value_container *
+{
+    auto it = container->child_indices.find(field.symbol());
+    if (it != container->child_indices.end() && it->second->type == value_type::single) {
+        return it->second;
+    }
+
+    for (auto sub_container : container->children) {
+        if (sub_container->type != value_type::list) {
+            continue;
+        }
+        if (auto found = find_single_value_container(field, sub_container)) {
+            return found;
+        }
+    }
+
+    return nullptr;
+}
+
+auto kdl::build_target::resource_constructor::assertion_value(const lexeme &field, enum binary_type type) const -> std::optional<assertion::value>
+{
+    auto container = find_single_value_container(field, m_values);
+    if (!container) {
+        return {};
+    }
+
+    switch (type & ~0xFFFUL) {
+        case build_target::HBYT: {
+            return assertion::value { lexeme::integer, std::get<std::uint8_t>(container->value), {} };
+        }
+        case build_target::HWRD: {
+            return assertion::value { lexeme::integer, std::get<std::uint16_t>(container->value), {} };
+        }
+        case build_target::HLNG: {
+            return assertion::value { lexeme::integer, std::get<std::uint32_t>(container->value), {} };
+        }
+        case build_target::HQAD: {
+            return assertion::value { lexeme::integer, std::get<std::uint64_t>(container->value), {} };
+        }
+        case build_target::DBYT: {
+            return assertion::value { lexeme::integer, std::get<std::int8_t>(container->value), {} };
+        }
+        case build_target::DWRD: {
+            return assertion::value { lexeme::integer, std::get<std::int16_t>(container->value), {} };
+        }
+        case build_target::DLNG: {
+            return assertion::value { lexeme::integer, std::get<std::int32_t>(container->value), {} };
+        }
+        case build_target::DQAD: {
+            return assertion::value { lexeme::integer, std::get<std::int64_t>(container->value), {} };
+        }
+        case build_target::PSTR:
+        case build_target::CSTR:
+        case build_target::Cnnn: {
+            const auto& str = std::get<std::tuple<std::size_t, std::string>>(container->value);
+            return assertion::value { lexeme::string, 0, std::get<1>(str) };
+        }
+        default: {
+            return {};
+        }
+    }
+}
+
 // MARK: - Assembly
 
-auto kdl::build_target::resource_constructor::assemble() -> graphite::data::block
+auto kdl::build_target::resource_constructor::assemble(std::vector<id_relocation> *relocations) -> graphite::data::block
 {
     graphite::data::writer writer(graphite::data::byte_order::msb);
-    assemble_list(writer, m_values);
+    assemble_list(writer, m_values, nullptr, relocations);
     return std::move(*const_cast<graphite::data::block *>(writer.data()));
 }
 
-auto kdl::build_target::resource_constructor::assemble_list(graphite::data::writer& writer, value_container *container, const type_template::binary_field* bin_field) -> void
+auto kdl::build_target::resource_constructor::assemble_list(graphite::data::writer& writer, value_container *container, const type_template::binary_field* bin_field, std::vector<id_relocation> *relocations) -> void
 {
-    auto& fields = bin_field ? bin_field->list_fields : m_tmpl.fields();
+    auto& fields = bin_field ? bin_field->list_fields : m_tmpl->fields();
 
     for (const auto& field : fields) {
         auto type = field.type;
         auto field_name = field.label;
-        auto base_value = value_container_at(field_name.text(), container);
+        auto base_value = child_container_named(field_name, container);
 
         if (!base_value) {
             writer.write_byte(0, build_target::binary_type_base_size(type));
         }
-        else if (!base_value->value.has_value()) {
-            log::fatal_error(field_name, 1, "Missing value for field '" + field_name.text() + "'.");
-        }
         else if (((type & ~0xFFFUL) == build_target::OCNT) && (base_value->type == value_type::list)) {
-            auto list = std::any_cast<std::vector<value_container *>>(base_value->value);
+            const auto& list = base_value->children;
             assemble_field(writer, build_target::HWRD, static_cast<std::uint16_t>(list.size()));
             for (auto element : list) {
-                assemble_list(writer, element, &field);
+                assemble_list(writer, element, &field, relocations);
             }
         }
+        else if ((base_value->type == value_type::single) && std::holds_alternative<std::monostate>(base_value->value)) {
+            log::fatal_error(field_name, 1, "Missing value for field '" + field_name.text() + "'.");
+        }
         else if (type == build_target::LSTC) {
             continue;
         }
@@ -450,47 +561,74 @@ auto kdl::build_target::resource_constructor::assemble_list(graphite::data::writ
         else {
             // This is a single value...
             assemble_field(writer, type, base_value->value);
+
+            // Resource ids are always the last value written for a field, so the reference can be located from
+            // where the field ends.
+            if (relocations && base_value->automatic_reference.has_value()) {
+                std::optional<std::pair<std::size_t, std::int64_t>> id;
+                if (auto value = std::get_if<std::int16_t>(&base_value->value)) {
+                    id = std::pair(sizeof(std::int16_t), *value);
+                }
+                else if (auto value = std::get_if<std::int32_t>(&base_value->value)) {
+                    id = std::pair(sizeof(std::int32_t), *value);
+                }
+                else if (auto value = std::get_if<std::int64_t>(&base_value->value)) {
+                    id = std::pair(sizeof(std::int64_t), *value);
+                }
+                else if (auto ref = std::get_if<std::tuple<std::uint8_t, std::string, std::string, std::int64_t>>(&base_value->value)) {
+                    id = std::pair(sizeof(std::int64_t), std::get<3>(*ref));
+                }
+
+                if (id.has_value()) {
+                    relocations->emplace_back(id_relocation {
+                        writer.position() - id->first,
+                        id->first,
+                        symbol_table::shared()[base_value->automatic_reference.value()].text,
+                        id->second
+                    });
+                }
+            }
         }
     }
 }
 
-auto kdl::build_target::resource_constructor::assemble_field(graphite::data::writer &writer, enum binary_type type, const std::any &value) const -> void
+auto kdl::build_target::resource_constructor::assemble_field(graphite::data::writer &writer, enum binary_type type, const stored_value &value) const -> void
 {
     switch (type & ~0xFFFUL) {
         case build_target::HBYT: {
-            writer.write_byte(std::any_cast<std::uint8_t>(value));
+            writer.write_byte(std::get<std::uint8_t>(value));
             break;
         }
         case build_target::HWRD: {
-            writer.write_short(std::any_cast<std::uint16_t>(value));
+            writer.write_short(std::get<std::uint16_t>(value));
             break;
         }
         case build_target::HLNG: {
-            writer.write_long(std::any_cast<std::uint32_t>(value));
+            writer.write_long(std::get<std::uint32_t>(value));
             break;
         }
         case build_target::HQAD: {
-            writer.write_quad(std::any_cast<std::uint64_t>(value));
+            writer.write_quad(std::get<std::uint64_t>(value));
             break;
         }
         case build_target::DBYT: {
-            writer.write_signed_byte(std::any_cast<std::int8_t>(value));
+            writer.write_signed_byte(std::get<std::int8_t>(value));
             break;
         }
         case build_target::DWRD: {
-            writer.write_signed_short(std::any_cast<std::int16_t>(value));
+            writer.write_signed_short(std::get<std::int16_t>(value));
             break;
         }
         case build_target::DLNG: {
-            writer.write_signed_long(std::any_cast<std::int32_t>(value));
+            writer.write_signed_long(std::get<std::int32_t>(value));
             break;
         }
         case build_target::DQAD: {
-            writer.write_signed_quad(std::any_cast<std::int64_t>(value));
+            writer.write_signed_quad(std::get<std::int64_t>(value));
             break;
         }
         case build_target::RECT: {
-            auto rect = std::any_cast<std::tuple<std::int16_t, std::int16_t, std::int16_t, std::int16_t>>(value);
+            const auto& rect = std::get<std::tuple<std::int16_t, std::int16_t, std::int16_t, std::int16_t>>(value);
             writer.write_signed_short(std::get<0>(rect));
             writer.write_signed_short(std::get<1>(rect));
             writer.write_signed_short(std::get<2>(rect));
@@ -498,34 +636,36 @@ auto kdl::build_target::resource_constructor::assemble_field(graphite::data::wri
             break;
         }
         case build_target::HEXD: {
-            if (value.type() == typeid(std::vector<char>)) {
-                auto bytes = std::any_cast<std::vector<char>>(value);
-                writer.write_bytes(bytes);
+            if (auto bytes = std::get_if<std::vector<char>>(&value)) {
+                writer.write_bytes(*bytes);
             }
-            else if (value.type() == typeid(std::vector<std::uint8_t>)) {
-                auto bytes = std::any_cast<std::vector<std::uint8_t>>(value);
-                writer.write_bytes(bytes);
+            else if (auto bytes = std::get_if<std::vector<std::uint8_t>>(&value)) {
+                writer.write_bytes(*bytes);
             }
-            else if (value.type() == typeid(graphite::data::block)) {
-                auto data = std::any_cast<graphite::data::block>(value);
-                writer.write_data(&data);
+            else if (auto data = std::get_if<graphite::data::block>(&value)) {
+                writer.write_data(data);
+            }
+            else if (auto deferred = std::get_if<std::shared_ptr<const deferred_data>>(&value)) {
+                auto produced = (*deferred)->produce();
+                writer.write_data(&produced);
             }
             break;
         }
         case build_target::PSTR: {
-            auto pstr = std::any_cast<std::tuple<std::size_t, std::string>>(value);
+            const auto& pstr = std::get<std::tuple<std::size_t, std::string>>(value);
             writer.write_pstr(std::get<1>(pstr));
             break;
         }
         case build_target::Cnnn:
         case build_target::CSTR: {
-            auto cstr = std::any_cast<std::tuple<std::size_t, std::string>>(value);
+            const auto& cstr = std::get<std::tuple<std::size_t, std::string>>(value);
             writer.write_cstr(std::get<1>(cstr), std::get<0>(cstr));
             break;
         }
         case build_target::RSRC: {
-            if (m_target->is_extended_format()) {
-                auto ref = std::any_cast<std::tuple<std::uint8_t, std::string, std::string, std::int64_t>>(value);
+            auto target = m_target.lock();
+            if (target && target->is_extended_format()) {
+                const auto& ref = std::get<std::tuple<std::uint8_t, std::string, std::string, std::int64_t>>(value);
                 writer.write_byte(std::get<0>(ref));
 
                 if (std::get<0>(ref) & 0x01) {
@@ -541,7 +681,7 @@ auto kdl::build_target::resource_constructor::assemble_field(graphite::data::wri
                 writer.write_signed_quad(std::get<3>(ref));
             }
             else {
-                writer.write_signed_short(std::any_cast<std::int16_t>(value));
+                writer.write_signed_short(std::get<std::int16_t>(value));
                 break;
             }
             break;
@@ -550,4 +690,235 @@ auto kdl::build_target::resource_constructor::assemble_field(graphite::data::wri
             throw std::logic_error("Type not handled");
         }
     }
-}
\ No newline at end of file
+}
+
+// MARK: - Intermediate Representation
+
+auto kdl::build_target::resource_constructor::write_ir(std::ostream &stream) const -> void
+{
+    stream << "resource '" << m_type_code << "' #" << m_id;
+    if (!m_name.empty()) {
+        stream << " \"" << m_name << "\"";
+    }
+    stream << " {" << std::endl;
+
+    for (const auto& attribute : m_attributes) {
+        stream << "    @" << attribute.first << " = \"" << attribute.second << "\"" << std::endl;
+    }
+
+    write_ir_list(stream, m_values, nullptr, "    ");
+    stream << "}" << std::endl;
+}
+
+auto kdl::build_target::resource_constructor::write_ir_list(std::ostream &stream, value_container *container, const type_template::binary_field *bin_field, const std::string& indent) const -> void
+{
+    const auto& fields = bin_field ? bin_field->list_fields : m_tmpl->fields();
+
+    for (const auto& field : fields) {
+        auto type = field.type;
+        auto base_value = const_value_container_at(field.label, container);
+
+        if (type == build_target::LSTC) {
+            continue;
+        }
+        else if (type == build_target::LSTE) {
+            return;
+        }
+
+        stream << indent << field.label.text() << " " << binary_type_name(type) << " = ";
+
+        if (!base_value) {
+            stream << "<unset>" << std::endl;
+        }
+        else if (((type & ~0xFFFUL) == build_target::OCNT) && (base_value->type == value_type::list)) {
+            stream << "[" << std::endl;
+            for (auto element : base_value->children) {
+                stream << indent << "    {" << std::endl;
+                write_ir_list(stream, element, &field, indent + "        ");
+                stream << indent << "    }" << std::endl;
+            }
+            stream << indent << "]" << std::endl;
+        }
+        else {
+            write_ir_value(stream, base_value->value);
+            stream << std::endl;
+        }
+    }
+}
+
+auto kdl::build_target::resource_constructor::write_ir_value(std::ostream &stream, const stored_value &value) -> void
+{
+    if (std::holds_alternative<std::monostate>(value)) {
+        stream << "<missing>";
+    }
+    else if (auto v = std::get_if<std::uint8_t>(&value)) {
+        stream << static_cast<std::uint32_t>(*v);
+    }
+    else if (auto v = std::get_if<std::uint16_t>(&value)) {
+        stream << *v;
+    }
+    else if (auto v = std::get_if<std::uint32_t>(&value)) {
+        stream << *v;
+    }
+    else if (auto v = std::get_if<std::uint64_t>(&value)) {
+        stream << *v;
+    }
+    else if (auto v = std::get_if<std::int8_t>(&value)) {
+        stream << static_cast<std::int32_t>(*v);
+    }
+    else if (auto v = std::get_if<std::int16_t>(&value)) {
+        stream << *v;
+    }
+    else if (auto v = std::get_if<std::int32_t>(&value)) {
+        stream << *v;
+    }
+    else if (auto v = std::get_if<std::int64_t>(&value)) {
+        stream << *v;
+    }
+    else if (auto str = std::get_if<std::tuple<std::size_t, std::string>>(&value)) {
+        stream << "\"" << std::get<1>(*str) << "\"";
+    }
+    else if (auto rect = std::get_if<std::tuple<std::int16_t, std::int16_t, std::int16_t, std::int16_t>>(&value)) {
+        stream << "(" << std::get<0>(*rect) << ", " << std::get<1>(*rect) << ", "
+               << std::get<2>(*rect) << ", " << std::get<3>(*rect) << ")";
+    }
+    else if (auto ref = std::get_if<std::tuple<std::uint8_t, std::string, std::string, std::int64_t>>(&value)) {
+        stream << "#";
+        if (!std::get<1>(*ref).empty()) {
+            stream << std::get<1>(*ref) << ".";
+        }
+        if (!std::get<2>(*ref).empty()) {
+            stream << "'" << std::get<2>(*ref) << "'.";
+        }
+        stream << std::get<3>(*ref);
+    }
+    else if (auto bytes = std::get_if<std::vector<char>>(&value)) {
+        stream << "<" << bytes->size() << " bytes>";
+    }
+    else if (auto bytes = std::get_if<std::vector<std::uint8_t>>(&value)) {
+        stream << "<" << bytes->size() << " bytes>";
+    }
+    else if (auto data = std::get_if<graphite::data::block>(&value)) {
+        stream << "<" << data->size() << " bytes>";
+    }
+    else if (auto deferred = std::get_if<std::shared_ptr<const deferred_data>>(&value)) {
+        stream << "<deferred " << (*deferred)->description << ">";
+    }
+}
+
+// MARK: - Assembly Cache
+
+auto kdl::build_target::resource_constructor::cache_key() const -> std::optional<std::string>
+{
+    content_digest digest;
+    auto has_deferred_data = false;
+
+    // A different version of KDL may assemble the same values differently, so never reuse its entries.
+    digest.update(KDL_VERSION);
+
+    // The encoding of resource references depends on the format of the output file.
+    auto target = m_target.lock();
+    digest.update_value(static_cast<std::uint8_t>(target && target->is_extended_format()));
+    digest_list(digest, m_values, nullptr, has_deferred_data);
+
+    if (!has_deferred_data) {
+        return {};
+    }
+    return digest.hex();
+}
+
+auto kdl::build_target::resource_constructor::digest_list(content_digest& digest, value_container *container, const type_template::binary_field *bin_field, bool& has_deferred_data) const -> void
+{
+    const auto& fields = bin_field ? bin_field->list_fields : m_tmpl->fields();
+
+    for (const auto& field : fields) {
+        auto type = field.type;
+        auto base_value = const_value_container_at(field.label, container);
+
+        digest.update_value(static_cast<std::uint64_t>(type));
+        digest.update(field.label.text());
+
+        if (!base_value) {
+            digest.update_value(static_cast<std::uint8_t>(0));
+        }
+        else if (((type & ~0xFFFUL) == build_target::OCNT) && (base_value->type == value_type::list)) {
+            digest.update_value(static_cast<std::uint8_t>(1));
+            digest.update_value(static_cast<std::uint64_t>(base_value->children.size()));
+            for (auto element : base_value->children) {
+                digest_list(digest, element, &field, has_deferred_data);
+            }
+        }
+        else if (type == build_target::LSTC) {
+            continue;
+        }
+        else if (type == build_target::LSTE) {
+            return;
+        }
+        else {
+            digest.update_value(static_cast<std::uint8_t>(2));
+            digest_value(digest, base_value->value, has_deferred_data);
+        }
+    }
+}
+
+auto kdl::build_target::resource_constructor::digest_value(content_digest& digest, const stored_value& value, bool& has_deferred_data) -> void
+{
+    digest.update_value(static_cast<std::uint64_t>(value.index()));
+
+    if (auto v = std::get_if<std::uint8_t>(&value)) {
+        digest.update_value(*v);
+    }
+    else if (auto v = std::get_if<std::uint16_t>(&value)) {
+        digest.update_value(*v);
+    }
+    else if (auto v = std::get_if<std::uint32_t>(&value)) {
+        digest.update_value(*v);
+    }
+    else if (auto v = std::get_if<std::uint64_t>(&value)) {
+        digest.update_value(*v);
+    }
+    else if (auto v = std::get_if<std::int8_t>(&value)) {
+        digest.update_value(*v);
+    }
+    else if (auto v = std::get_if<std::int16_t>(&value)) {
+        digest.update_value(*v);
+    }
+    else if (auto v = std::get_if<std::int32_t>(&value)) {
+        digest.update_value(*v);
+    }
+    else if (auto v = std::get_if<std::int64_t>(&value)) {
+        digest.update_value(*v);
+    }
+    else if (auto str = std::get_if<std::tuple<std::size_t, std::string>>(&value)) {
+        digest.update_value(static_cast<std::uint64_t>(std::get<0>(*str)));
+        digest.update(std::get<1>(*str));
+    }
+    else if (auto rect = std::get_if<std::tuple<std::int16_t, std::int16_t, std::int16_t, std::int16_t>>(&value)) {
+        digest.update_value(std::get<0>(*rect));
+        digest.update_value(std::get<1>(*rect));
+        digest.update_value(std::get<2>(*rect));
+        digest.update_value(std::get<3>(*rect));
+    }
+    else if (auto ref = std::get_if<std::tuple<std::uint8_t, std::string, std::string, std::int64_t>>(&value)) {
+        digest.update_value(std::get<0>(*ref));
+        digest.update(std::get<1>(*ref));
+        digest.update(std::get<2>(*ref));
+        digest.update_value(std::get<3>(*ref));
+    }
+    else if (auto bytes = std::get_if<std::vector<char>>(&value)) {
+        digest.update(std::string_view(bytes->data(), bytes->size()));
+    }
+    else if (auto bytes = std::get_if<std::vector<std::uint8_t>>(&value)) {
+        digest.update(std::string_view(reinterpret_cast<const char *>(bytes->data()), bytes->size()));
+    }
+    else if (auto data = std::get_if<graphite::data::block>(&value)) {
+        graphite::data::reader reader(data);
+        auto bytes = reader.read_bytes(reader.size());
+        digest.update(std::string_view(bytes.data(), bytes.size()));
+    }
+    else if (auto deferred = std::get_if<std::shared_ptr<const deferred_data>>(&value)) {
+        // The deferred data is represented by what it will be produced from, so that it does not need producing.
+        digest.update((*deferred)->fingerprint);
+        has_deferred_data = true;
+    }
+}
@@ -20,16 +20,22 @@
 
 #pragma once
 
-#include <any>
+#include <deque>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <optional>
-#include <string>
+#include <ostream>
 #include <functional>
+#include <tuple>
 #include <unordered_map>
+#include <variant>
+#include <vector>
 #include "parser/lexeme.hpp"
 #include "target/new/type_template.hpp"
 #include "target/new/type_field.hpp"
 #include "target/new/binary_type.hpp"
+#include "target/assertion.hpp"
 #include "libGraphite/data/data.hpp"
 #include "libGraphite/data/writer.hpp"
 
@@ -40,21 +46,75 @@ namespace kdl
 
 namespace kdl::build_target
 {
+    class content_digest;
+
+    /**
+     * Data for a field that is only produced when the resource is assembled, such as the result of converting
+     * media from one format to another. The description is used when the resource is shown as IR. The fingerprint
+     * is a digest of everything that the data is produced from, and identifies it in the assembly cache.
+     */
+    struct deferred_data
+    {
+        std::string description;
+        std::function<auto() -> graphite::data::block> produce;
+        std::string fingerprint;
+    };
+
+    /**
+     * The location of a resource id within the assembled data of a resource, where the id refers to a resource that
+     * was allocated its id automatically. Should that resource be given a different id when it is linked, then the
+     * reference is updated to match.
+     */
+    struct id_relocation
+    {
+        std::size_t offset;
+        std::size_t width;
+        std::string type_code;
+        std::int64_t id;
+    };
+
     class resource_constructor
     {
     public:
-        resource_constructor(std::shared_ptr<target> target, graphite::rsrc::resource::identifier id, const std::string& code, const std::string& name, type_template tmpl);
-        resource_constructor(std::shared_ptr<target> target, graphite::rsrc::resource::identifier id, const std::string& code, const std::string& name, const std::string& contents);
+        /**
+         * A value that has been written to a field of the resource. Each alternative is one of the
+         * representations that the resource knows how to assemble.
+         */
+        typedef std::variant<
+            std::monostate,
+            std::uint8_t, std::uint16_t, std::uint32_t, std::uint64_t,
+            std::int8_t, std::int16_t, std::int32_t, std::int64_t,
+            std::tuple<std::size_t, std::string>,
+            std::tuple<std::int16_t, std::int16_t, std::int16_t, std::int16_t>,
+            std::tuple<std::uint8_t, std::string, std::string, std::int64_t>,
+            std::vector<char>,
+            std::vector<std::uint8_t>,
+            graphite::data::block,
+            std::shared_ptr<const deferred_data>
+        > stored_value;
+
+    public:
+        resource_constructor(std::shared_ptr<target> target, graphite::rsrc::resource::identifier id, const std::string& code, const std::string& name, std::shared_ptr<const class type_template> tmpl);
+        resource_constructor(std::shared_ptr<target> target, graphite::rsrc::resource::identifier id, const std::string& code, const std::string& name, std::string_view contents);
         resource_constructor(std::shared_ptr<target> target, graphite::rsrc::resource::identifier id, const std::string& code, const std::string& name, const graphite::data::block& data);
 
     private:
         enum class value_type { single, list };
 
+        /**
+         * A node in the value tree of the resource. List containers hold their children in order, along with
+         * an index of the named children so that they can be found without scanning the list.
+         */
         struct value_container {
-            std::string name;
+            lexeme name;
             enum value_type type { value_type::single };
-            std::any value;
+            stored_value value;
+            std::vector<value_container *> children;
+            std::unordered_map<symbol_table::symbol, value_container *> child_indices;
             std::int32_t field_count { 0 };
+            std::optional<symbol_table::symbol> automatic_reference;
+
+            value_container(const lexeme& name, enum value_type type) : name(name), type(type) {}
         };
 
     public:
@@ -62,11 +122,24 @@ namespace kdl::build_target
         [[nodiscard]] auto id() const -> graphite::rsrc::resource::identifier;
         [[nodiscard]] auto name() const -> const std::string&;
 
+        /**
+         * Resources declared with #auto have their id allocated by the resource tracker. Such resources may be given
+         * a different id when they are linked with the resources of other object files.
+         */
+        auto set_automatic_id(bool automatic) -> void;
+        [[nodiscard]] auto has_automatic_id() const -> bool;
+
         auto value_container_at(const std::string& path, value_container *container = nullptr) -> value_container *;
         auto value_container_at(const lexeme& field) -> value_container *;
 
         auto add_list_element(const lexeme& field, const std::function<auto(resource_constructor *)->void>& callback) -> void;
 
+        /**
+         * Replace the values of the resource with a copy of those held by another resource of the same type.
+         * This is used to seed a new resource with the default values of its type.
+         */
+        auto copy_values(const resource_constructor& source) -> void;
+
         auto write_byte(const type_field& field, const type_field_value& field_value, std::uint8_t value) -> void;
         auto write_short(const type_field& field, const type_field_value& field_value, std::uint16_t value) -> void;
         auto write_long(const type_field& field, const type_field_value& field_value, std::uint32_t value) -> void;
@@ -81,15 +154,47 @@ namespace kdl::build_target
         auto write_data(const type_field& field, const type_field_value& field_value, const std::vector<char>& data) -> void;
         auto write_data(const type_field& field, const type_field_value& field_value, const std::vector<std::uint8_t>& data) -> void;
         auto write_data(const type_field& field, const type_field_value& field_value, const graphite::data::block& data) -> void;
+        auto write_data(const type_field& field, const type_field_value& field_value, std::shared_ptr<const deferred_data> data) -> void;
         auto write_rect(const type_field& field, const type_field_value& field_value, std::int16_t t, std::int16_t l, std::int16_t b, std::int16_t r) -> void;
 
         auto write_resource_reference(const type_field& field, const type_field_value& field_value, const lexeme& ref) -> void;
 
-        auto write(const std::string& field, std::any value) -> void;
-
-        auto assemble() -> graphite::data::block;
+        /**
+         * Note that the value of a field is the id of a resource of the specified type, which was allocated
+         * automatically. The location of the id is reported when the resource is assembled.
+         */
+        auto mark_automatic_reference(const type_field& field, const type_field_value& field_value, const std::string& type_code) -> void;
+
+        auto write(const std::string& field, stored_value value) -> void;
+        auto write(const lexeme& field, stored_value value) -> void;
+
+        /**
+         * Assemble the values of the resource into binary data. If relocations are requested, then the location of
+         * every reference to a resource with an automatically allocated id is added to them.
+         */
+        auto assemble(std::vector<id_relocation> *relocations = nullptr) -> graphite::data::block;
+
+        /**
+         * The key under which the assembled data of the resource is held in the assembly cache. This is a digest of
+         * the template of the resource, every value written to it and the version of KDL, so it changes whenever
+         * anything that the data is assembled from changes. Only resources that contain deferred data are worth caching, as every
+         * other resource is quicker to assemble than to look up, and so have no key.
+         */
+        [[nodiscard]] auto cache_key() const -> std::optional<std::string>;
+
+        /**
+         * Write a textual description of the resource and each of its resolved field values, in template order.
+         */
+        auto write_ir(std::ostream& stream) const -> void;
         [[nodiscard]] auto synthesize_variables(value_container *container = nullptr) const -> std::unordered_map<std::string, lexeme>;
 
+        /**
+         * Read the value of a field as an assertion sees it. Fields inside lists take the value of the first list
+         * element that contains them. Fields that have not been written, or that are not of a numeric or string
+         * type, have no value.
+         */
+        [[nodiscard]] auto assertion_value(const lexeme& field, enum binary_type type) const -> std::optional<assertion::value>;
+
         auto set_attributes(const std::unordered_map<std::string, std::string>& attributes) -> void;
         auto set_attribute(const std::string& name, const std::string& value) -> void;
         [[nodiscard]] auto attributes() const -> std::unordered_map<std::string, std::string>;
@@ -101,21 +206,33 @@ namespace kdl::build_target
         [[nodiscard]] auto type_template() const -> const type_template&;
 
     private:
-        std::shared_ptr<target> m_target { nullptr };
+        std::weak_ptr<target> m_target;
+        std::shared_ptr<std::deque<value_container>> m_arena { std::make_shared<std::deque<value_container>>() };
         value_container *m_values { nullptr };
         value_container *m_pushed_container { nullptr };
         std::string m_type_code;
         graphite::rsrc::resource::identifier m_id;
         std::string m_name;
-        class type_template m_tmpl;
+        std::shared_ptr<const class type_template> m_tmpl;
         std::unordered_map<std::string, std::string> m_attributes;
+        bool m_automatic_id { false };
 
-        auto construct_root_value_container() -> void;
-        [[nodiscard]] auto available_name_extensions(const type_field& field) const -> std::unordered_map<std::string, lexeme>;
-
-        [[nodiscard]] auto const_value_container_at(const std::string& path, value_container *container = nullptr) const -> value_container *;
+        static auto data_template(enum binary_type type) -> std::shared_ptr<const class type_template>;
 
-        auto assemble_list(graphite::data::writer& writer, value_container *container, const type_template::binary_field* bin_field = nullptr) -> void;
-        auto assemble_field(graphite::data::writer& writer, enum binary_type type, const std::any& value) const -> void;
+        auto construct_root_value_container() -> void;
+        auto make_value_container(const lexeme& name, enum value_type type) -> value_container *;
+        auto copy_value_container(const value_container *source) -> value_container *;
+        auto child_container_named(const lexeme& name, value_container *container) -> value_container *;
+        [[nodiscard]] auto field_number(const type_field& field) const -> std::optional<std::int32_t>;
+
+        [[nodiscard]] auto const_value_container_at(const lexeme& field, value_container *container = nullptr) const -> value_container *;
+        [[nodiscard]] auto find_single_value_container(const lexeme& field, value_container *container) const -> value_container *;
+
+        auto assemble_list(graphite::data::writer& writer, value_container *container, const type_template::binary_field* bin_field, std::vector<id_relocation> *relocations) -> void;
+        auto assemble_field(graphite::data::writer& writer, enum binary_type type, const stored_value& value) const -> void;
+        auto write_ir_list(std::ostream& stream, value_container *container, const type_template::binary_field* bin_field, const std::string& indent) const -> void;
+        static auto write_ir_value(std::ostream& stream, const stored_value& value) -> void;
+        auto digest_list(content_digest& digest, value_container *container, const type_template::binary_field* bin_field, bool& has_deferred_data) const -> void;
+        static auto digest_value(content_digest& digest, const stored_value& value, bool& has_deferred_data) -> void;
     };
 }
@@ -46,26 +46,27 @@ kdl::build_target::type_container::type_container(std::string name, std::string
 
 // MARK: - Accessors
 
-auto kdl::build_target::type_container::name() const -> std::string
+auto kdl::build_target::type_container::name() const -> const std::string&
 {
     return m_name;
 }
 
-auto kdl::build_target::type_container::code() const -> std::string
+auto kdl::build_target::type_container::code() const -> const std::string&
 {
     return m_code;
 }
 
 // MARK: - Type Template Management
 
-auto kdl::build_target::type_container::internal_template() -> kdl::build_target::type_template&
+auto kdl::build_target::type_container::internal_template() const -> const kdl::build_target::type_template&
 {
-    return m_tmpl;
+    return *m_tmpl;
 }
 
 auto kdl::build_target::type_container::set_internal_template(const type_template& tmpl) -> void
 {
-    m_tmpl = tmpl;
+    // The template is immutable once set, and is shared by every instance of the type.
+    m_tmpl = std::make_shared<const type_template>(tmpl);
 }
 
 // MARK: - Type Field Management
@@ -81,31 +82,88 @@ auto kdl::build_target::type_container::add_field(const kdl::build_target::type_
     m_fields.emplace_back(field);
 }
 
-auto kdl::build_target::type_container::field_named(const kdl::lexeme& name) -> kdl::build_target::type_field
+auto kdl::build_target::type_container::field_named(const kdl::lexeme& name) const -> const kdl::build_target::type_field&
 {
-    for (auto field : m_fields) {
-        if (field.name().text() == name.text()) {
-            return field;
-        }
+    auto it = m_field_indices.find(name.symbol());
+    if (it != m_field_indices.end()) {
+        return m_fields[it->second];
     }
     log::fatal_error(name, 1, "The field '" + name.text() + "' could not be found in type '" + m_name + "'");
 }
 
-auto kdl::build_target::type_container::all_fields() const -> std::vector<type_field>
+auto kdl::build_target::type_container::all_fields() const -> const std::vector<type_field>&
 {
     return m_fields;
 }
 
 // MARK: - Instance
 
-auto kdl::build_target::type_container::new_instance(std::shared_ptr<target> target, const int64_t& id, std::optional<std::string> name) -> resource_constructor
+auto kdl::build_target::type_container::new_instance(std::shared_ptr<target> target, const int64_t& id, std::optional<std::string> name) const -> resource_constructor
 {
     return std::move(resource_constructor(target, id, m_code, name.has_value() ? name.value() : "", m_tmpl));
 }
 
+auto kdl::build_target::type_container::has_static_defaults() const -> bool
+{
+    return m_static_defaults;
+}
+
+auto kdl::build_target::type_container::default_prototype() const -> const resource_constructor *
+{
+    return m_default_prototype.get();
+}
+
+auto kdl::build_target::type_container::set_default_prototype(const resource_constructor& prototype) const -> void
+{
+    if (m_static_defaults) {
+        // Copies of a resource share their values, so take a deep copy that later changes to the resource can not affect.
+        auto copy = std::make_shared<resource_constructor>(prototype);
+        copy->copy_values(prototype);
+        m_default_prototype = std::move(copy);
+    }
+}
+
+// MARK: - Freezing
+
+auto kdl::build_target::type_container::freeze() -> void
+{
+    if (m_frozen) {
+        return;
+    }
+
+    // The first field to use a name takes precedence over any later fields.
+    for (std::size_t i = 0; i < m_fields.size(); ++i) {
+        auto& field = m_fields[i];
+        field.freeze();
+        m_field_indices.emplace(field.name().symbol(), i);
+
+        // Defaults that are variables may differ from one resource to the next, and so can not be shared.
+        for (std::size_t n = 0; n < field.expected_values(); ++n) {
+            const auto& default_value = field.value_at(n).default_value();
+            if (default_value.has_value() && (default_value->is(lexeme::var) || default_value->is(lexeme::l_expr))) {
+                m_static_defaults = false;
+            }
+        }
+    }
+
+    // Assertions read field values directly, so resolve their operands against the binary layout now.
+    if (m_tmpl) {
+        for (auto& assertion : m_assertions) {
+            assertion.compile(*m_tmpl);
+        }
+    }
+
+    m_frozen = true;
+}
+
+auto kdl::build_target::type_container::is_frozen() const -> bool
+{
+    return m_frozen;
+}
+
 // MARK: - Assertions
 
-auto kdl::build_target::type_container::assertions() const -> std::vector<assertion>
+auto kdl::build_target::type_container::assertions() const -> const std::vector<assertion>&
 {
     return m_assertions;
 }
@@ -24,6 +24,7 @@
 #include <string>
 #include <memory>
 #include <optional>
+#include <unordered_map>
 #include "target/new/type_template.hpp"
 #include "target/new/type_field.hpp"
 #include "parser/lexeme.hpp"
@@ -49,28 +50,49 @@ namespace kdl::build_target
         type_container(const lexeme& name, std::string code);
         type_container(std::string name, std::string code);
 
-        [[nodiscard]] auto name() const -> std::string;
-        [[nodiscard]] auto code() const -> std::string;
+        [[nodiscard]] auto name() const -> const std::string&;
+        [[nodiscard]] auto code() const -> const std::string&;
 
-        auto internal_template() -> type_template&;
+        [[nodiscard]] auto internal_template() const -> const type_template&;
         auto set_internal_template(const type_template& tmpl) -> void;
 
         auto add_field(const lexeme& name) -> type_field&;
         auto add_field(const type_field& field) -> void;
-        auto field_named(const lexeme& name) -> type_field;
-        [[nodiscard]] auto all_fields() const -> std::vector<type_field>;
+        [[nodiscard]] auto field_named(const lexeme& name) const -> const type_field&;
+        [[nodiscard]] auto all_fields() const -> const std::vector<type_field>&;
 
-        [[nodiscard]] auto assertions() const -> std::vector<assertion>;
+        [[nodiscard]] auto assertions() const -> const std::vector<assertion>&;
         auto add_assertions(const std::vector<assertion>& assertions) -> void;
 
-        auto new_instance(std::shared_ptr<target> target, const int64_t& id, std::optional<std::string> name = {}) -> resource_constructor;
+        [[nodiscard]] auto new_instance(std::shared_ptr<target> target, const int64_t& id, std::optional<std::string> name = {}) const -> resource_constructor;
+
+        /**
+         * The default values of a type are the same for every new resource, so they are applied once to a
+         * prototype resource that each subsequent resource is seeded from. Types with defaults that refer to
+         * variables have to resolve them for each resource, and so never have a prototype.
+         */
+        [[nodiscard]] auto has_static_defaults() const -> bool;
+        [[nodiscard]] auto default_prototype() const -> const resource_constructor *;
+        auto set_default_prototype(const resource_constructor& prototype) const -> void;
+
+        /**
+         * Freeze the type into its compiled form, building the indices used to look up fields, values and
+         * symbols. This is done once the type definition has been fully parsed, and the type should not be
+         * modified afterwards.
+         */
+        auto freeze() -> void;
+        [[nodiscard]] auto is_frozen() const -> bool;
 
     private:
         std::string m_code { "NULL" };
         std::string m_name;
-        type_template m_tmpl;
+        std::shared_ptr<const type_template> m_tmpl { std::make_shared<const type_template>() };
         std::vector<type_field> m_fields;
         std::vector<assertion> m_assertions;
+        std::unordered_map<symbol_table::symbol, std::size_t> m_field_indices;
+        mutable std::shared_ptr<const resource_constructor> m_default_prototype;
+        bool m_static_defaults { true };
+        bool m_frozen { false };
 
     };
 
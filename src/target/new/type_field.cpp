@@ -68,20 +68,16 @@ auto kdl::build_target::type_field::expected_values() const -> std::size_t
     return m_values.size();
 }
 
-auto kdl::build_target::type_field::value_at(int n) const -> kdl::build_target::type_field_value
+auto kdl::build_target::type_field::value_at(int n) const -> const kdl::build_target::type_field_value&
 {
     return m_values.at(n);
 }
 
-auto kdl::build_target::type_field::value_named(const lexeme &name) const -> type_field_value
+auto kdl::build_target::type_field::value_named(const lexeme &name) const -> const type_field_value&
 {
-    for (const auto& value : m_values) {
-        if (value.base_name().is(name.text())) {
-            return value;
-        }
-        else if (value.export_name().has_value() && value.export_name()->is(name.text())) {
-            return value;
-        }
+    auto it = m_value_indices.find(name.symbol());
+    if (it != m_value_indices.end()) {
+        return m_values[it->second];
     }
     log::fatal_error(name, 1, "Could not find value named '" + name.text() + "' in field '" + this->name().text() + "'");
 }
@@ -135,4 +131,22 @@ auto kdl::build_target::type_field::wants_lua_setter() const -> bool
 auto kdl::build_target::type_field::set_lua_setter(bool f) -> void
 {
     m_lua_setter = f;
-}
\ No newline at end of file
+}
+
+// MARK: - Freezing
+
+auto kdl::build_target::type_field::freeze() -> void
+{
+    // Values can be referred to by either their base name or export name. The first value to use a name takes
+    // precedence over any later values.
+    m_value_indices.clear();
+    for (auto i = 0; i < m_values.size(); ++i) {
+        auto& value = m_values[i];
+        value.freeze(m_repeatable_lower, m_repeatable_upper);
+
+        m_value_indices.emplace(value.base_name().symbol(), i);
+        if (value.export_name().has_value()) {
+            m_value_indices.emplace(value.export_name()->symbol(), i);
+        }
+    }
+}
@@ -24,6 +24,7 @@
 #include <tuple>
 #include <vector>
 #include <string>
+#include <unordered_map>
 #include "target/new/kdl_type.hpp"
 #include "target/new/type_field_value.hpp"
 #include "parser/lexeme.hpp"
@@ -40,8 +41,8 @@ namespace kdl::build_target
 
         auto add_value(const type_field_value& value) -> void;
         [[nodiscard]] auto expected_values() const -> std::size_t;
-        [[nodiscard]] auto value_at(int n) const -> type_field_value;
-        [[nodiscard]] auto value_named(const lexeme& name) const -> type_field_value;
+        [[nodiscard]] auto value_at(int n) const -> const type_field_value&;
+        [[nodiscard]] auto value_named(const lexeme& name) const -> const type_field_value&;
 
         auto make_repeatable(int lower, int upper) -> void;
         [[nodiscard]] auto lower_repeat_bound() const -> int;
@@ -54,6 +55,11 @@ namespace kdl::build_target
         [[nodiscard]] auto wants_lua_setter() const -> bool;
         auto set_lua_setter(bool f) -> void;
 
+        /**
+         * Build the value name index of the field, and freeze each of its values.
+         */
+        auto freeze() -> void;
+
     private:
         lexeme m_name;
         std::vector<type_field_value> m_values;
@@ -62,6 +68,7 @@ namespace kdl::build_target
         int m_repeatable_upper { 0 };
         std::optional<lexeme> m_repeatable_count_field;
         bool m_lua_setter { false };
+        std::unordered_map<symbol_table::symbol, std::size_t> m_value_indices;
     };
 
 };
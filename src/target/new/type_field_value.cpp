@@ -18,11 +18,12 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <algorithm>
 #include "diagnostic/fatal.hpp"
 #include "type_field_value.hpp"
 
 kdl::build_target::type_field_value::type_field_value(const kdl::lexeme& base_name)
-    : m_base_name(base_name)
+    : m_base_name(base_name), m_plain_name(base_name.text(), lexeme::identifier)
 {
 
 }
@@ -45,6 +46,22 @@ auto kdl::build_target::type_field_value::extended_name(const std::unordered_map
     return { name, lexeme::identifier };
 }
 
+auto kdl::build_target::type_field_value::extended_name(std::optional<std::int32_t> field_number) const -> lexeme
+{
+    if (!field_number.has_value() || m_name_extensions.empty()) {
+        return m_plain_name;
+    }
+
+    auto index = static_cast<std::int64_t>(field_number.value()) - m_first_field_number;
+    if (index >= 0 && static_cast<std::size_t>(index) < m_extended_names.size()) {
+        return m_extended_names[static_cast<std::size_t>(index)];
+    }
+
+    return extended_name({
+        std::pair("FieldNumber", lexeme(std::to_string(field_number.value()), lexeme::integer))
+    });
+}
+
 auto kdl::build_target::type_field_value::export_name() const -> std::optional<lexeme>
 {
     return m_export_name;
@@ -86,6 +103,11 @@ auto kdl::build_target::type_field_value::set_name_extensions(const std::vector<
     m_name_extensions = name_extensions;
 }
 
+auto kdl::build_target::type_field_value::name_extensions() const -> const std::vector<lexeme>&
+{
+    return m_name_extensions;
+}
+
 // MARK: - Symbols
 
 auto kdl::build_target::type_field_value::set_symbols(const std::vector<std::tuple<lexeme, lexeme>>& symbols) -> void
@@ -93,17 +115,26 @@ auto kdl::build_target::type_field_value::set_symbols(const std::vector<std::tup
     m_symbols = symbols;
 }
 
-auto kdl::build_target::type_field_value::symbols() const -> std::vector<std::tuple<lexeme, lexeme>>
+auto kdl::build_target::type_field_value::symbols() const -> const std::vector<std::tuple<lexeme, lexeme>>&
 {
     return m_symbols;
 }
 
-auto kdl::build_target::type_field_value::value_for(const lexeme& symbol) const -> kdl::lexeme
+auto kdl::build_target::type_field_value::find_symbol(const kdl::lexeme& symbol) const -> const kdl::lexeme *
 {
-    for (auto value : m_symbols) {
-        if (std::get<0>(value).is(symbol.text())) {
-            return std::get<1>(value);
-        }
+    auto it = m_symbol_indices.find(symbol.symbol());
+    return (it == m_symbol_indices.end()) ? nullptr : &std::get<1>(m_symbols[it->second]);
+}
+
+auto kdl::build_target::type_field_value::has_symbol(const kdl::lexeme& symbol) const -> bool
+{
+    return find_symbol(symbol) != nullptr;
+}
+
+auto kdl::build_target::type_field_value::value_for(const lexeme& symbol) const -> const kdl::lexeme&
+{
+    if (auto value = find_symbol(symbol)) {
+        return *value;
     }
     log::fatal_error(symbol, 1, "Unrecognised symbol name '" + symbol.text() + "'");
 }
@@ -145,20 +176,16 @@ auto kdl::build_target::type_field_value::joined_value_count() const -> std::siz
 auto kdl::build_target::type_field_value::joined_value_for(const kdl::lexeme& symbol) const -> std::optional<std::tuple<int, lexeme>>
 {
     // Check if the symbol is in this. If it is return an empty optional.
-    for (auto value : m_symbols) {
-        if (std::get<0>(value).is(symbol.text())) {
-            return {};
-        }
+    if (has_symbol(symbol)) {
+        return {};
     }
 
     // Now check through each of the joined values for the symbol, return the type_field_value instance and the value
     // of the symbol, if it is found.
     int i = 0;
     for (const auto& field_value : m_joined_values) {
-        for (auto value : field_value.m_symbols) {
-            if (std::get<0>(value).is(symbol.text())) {
-                return std::tuple(i, std::get<1>(value));
-            }
+        if (auto value = field_value.find_symbol(symbol)) {
+            return std::tuple(i, *value);
         }
         ++i;
     }
@@ -166,7 +193,7 @@ auto kdl::build_target::type_field_value::joined_value_for(const kdl::lexeme& sy
     log::fatal_error(symbol, 1, "Unrecognised symbol name '" + symbol.text() + "'");
 }
 
-auto kdl::build_target::type_field_value::joined_value_at(int i) -> kdl::build_target::type_field_value
+auto kdl::build_target::type_field_value::joined_value_at(int i) const -> const kdl::build_target::type_field_value&
 {
     return m_joined_values.at(i);
 }
@@ -182,3 +209,31 @@ auto kdl::build_target::type_field_value::assemble_sprite_sheet() const -> bool
 {
     return m_assemble_sprite_sheet;
 }
+
+// MARK: - Freezing
+
+auto kdl::build_target::type_field_value::freeze(std::int32_t first_field_number, std::int32_t last_field_number) -> void
+{
+    // The first definition of a symbol takes precedence over any later redefinitions.
+    m_symbol_indices.clear();
+    for (std::size_t i = 0; i < m_symbols.size(); ++i) {
+        m_symbol_indices.emplace(std::get<0>(m_symbols[i]).symbol(), i);
+    }
+
+    // Fields with very large repeat bounds rarely use all of them, so only the leading names are built up front and
+    // any beyond those are built when needed.
+    constexpr std::int64_t max_extended_names = 1024;
+    auto count = std::min(static_cast<std::int64_t>(last_field_number) - first_field_number + 1, max_extended_names);
+
+    m_first_field_number = first_field_number;
+    m_extended_names.clear();
+    for (auto i = 0; !m_name_extensions.empty() && i < count; ++i) {
+        m_extended_names.emplace_back(extended_name({
+            std::pair("FieldNumber", lexeme(std::to_string(first_field_number + i), lexeme::integer))
+        }));
+    }
+
+    for (auto& value : m_joined_values) {
+        value.freeze(first_field_number, last_field_number);
+    }
+}
@@ -20,6 +20,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <vector>
 #include <optional>
 #include <tuple>
@@ -41,6 +42,13 @@ namespace kdl::build_target
         [[nodiscard]] auto base_name() const -> lexeme;
         [[nodiscard]] auto extended_name(const std::unordered_map<std::string, lexeme>& vars) const -> lexeme;
 
+        /**
+         * The name of the value when used as the specified field number. The names for each field number within
+         * the repeat bounds of the owning field are built when the value is frozen, so that repeatedly writing a
+         * field does not need to construct its name again.
+         */
+        [[nodiscard]] auto extended_name(std::optional<std::int32_t> field_number) const -> lexeme;
+
         [[nodiscard]] auto export_name() const -> std::optional<lexeme>;
         auto set_export_name(const lexeme& name) -> void;
 
@@ -51,10 +59,12 @@ namespace kdl::build_target
         [[nodiscard]] auto default_value() const -> std::optional<lexeme>;
 
         auto set_symbols(const std::vector<std::tuple<lexeme, lexeme>>& symbols) -> void;
-        [[nodiscard]] auto symbols() const -> std::vector<std::tuple<lexeme, lexeme>>;
-        [[nodiscard]] auto value_for(const lexeme& symbol) const -> lexeme;
+        [[nodiscard]] auto symbols() const -> const std::vector<std::tuple<lexeme, lexeme>>&;
+        [[nodiscard]] auto has_symbol(const lexeme& symbol) const -> bool;
+        [[nodiscard]] auto value_for(const lexeme& symbol) const -> const lexeme&;
 
         auto set_name_extensions(const std::vector<lexeme>& name_extensions) -> void;
+        [[nodiscard]] auto name_extensions() const -> const std::vector<lexeme>&;
 
         auto set_conversion_map(const std::tuple<lexeme, lexeme>& map) -> void;
         [[nodiscard]] auto has_conversion_defined() const -> bool;
@@ -63,12 +73,20 @@ namespace kdl::build_target
 
         auto join_value(const type_field_value& value) -> void;
         [[nodiscard]] auto joined_value_count() const -> std::size_t;
-        [[nodiscard]] auto joined_value_at(int i) -> type_field_value;
+        [[nodiscard]] auto joined_value_at(int i) const -> const type_field_value&;
         [[nodiscard]] auto joined_value_for(const lexeme& symbol) const -> std::optional<std::tuple<int, lexeme>>;
 
         auto set_assemble_sprite_sheet() -> void;
         [[nodiscard]] auto assemble_sprite_sheet() const -> bool;
 
+        /**
+         * Build the symbol index and extended names of the value, and of each of its joined values. This is done
+         * once the type definition that the value belongs to has been fully parsed.
+         * @param first_field_number The first field number that the owning field may be used as.
+         * @param last_field_number The last field number that the owning field may be used as.
+         */
+        auto freeze(std::int32_t first_field_number = 0, std::int32_t last_field_number = 0) -> void;
+
     private:
         std::optional<lexeme> m_export_name;
         lexeme m_base_name;
@@ -79,6 +97,12 @@ namespace kdl::build_target
         std::optional<std::tuple<lexeme, lexeme>> m_conversion_map;
         std::vector<type_field_value> m_joined_values;
         bool m_assemble_sprite_sheet { false };
+        std::unordered_map<symbol_table::symbol, std::size_t> m_symbol_indices;
+        lexeme m_plain_name;
+        std::int32_t m_first_field_number { 0 };
+        std::vector<lexeme> m_extended_names;
+
+        [[nodiscard]] auto find_symbol(const lexeme& symbol) const -> const lexeme *;
 
     };
 
@@ -0,0 +1,305 @@
+// Copyright (c) 2022 Tom Hancocks
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "target/new/type_module.hpp"
+
+// MARK: - Type Encoding
+
+namespace
+{
+    using kdl::build_target::module_reader;
+    using kdl::build_target::module_writer;
+
+    auto write_binary_field(module_writer& writer, const kdl::build_target::type_template::binary_field& field) -> void
+    {
+        writer.write_lexeme(field.label);
+        writer.write_u32(static_cast<std::uint32_t>(field.type));
+        writer.write_u32(static_cast<std::uint32_t>(field.list_fields.size()));
+        for (const auto& list_field : field.list_fields) {
+            write_binary_field(writer, list_field);
+        }
+    }
+
+    auto read_binary_field(module_reader& reader) -> kdl::build_target::type_template::binary_field
+    {
+        auto label = reader.read_lexeme();
+        auto type = static_cast<enum kdl::build_target::binary_type>(reader.read_u32());
+        kdl::build_target::type_template::binary_field field(label, type);
+
+        auto list_field_count = reader.read_u32();
+        for (std::uint32_t i = 0; i < list_field_count; ++i) {
+            field.list_fields.emplace_back(read_binary_field(reader));
+        }
+        return field;
+    }
+
+    auto write_field_value(module_writer& writer, const kdl::build_target::type_field_value& value) -> void
+    {
+        writer.write_lexeme(value.base_name());
+        writer.write_lexeme(value.export_name());
+
+        auto explicit_type = value.explicit_type();
+        writer.write_u8(explicit_type.has_value() ? 1 : 0);
+        if (explicit_type.has_value()) {
+            writer.write_u8(explicit_type->is_reference() ? 1 : 0);
+            writer.write_lexeme(explicit_type->name());
+
+            auto hints = explicit_type->type_hints();
+            writer.write_u32(static_cast<std::uint32_t>(hints.size()));
+            for (const auto& hint : hints) {
+                writer.write_lexeme(hint);
+            }
+        }
+
+        writer.write_lexeme(value.default_value());
+
+        writer.write_u32(static_cast<std::uint32_t>(value.symbols().size()));
+        for (const auto& symbol : value.symbols()) {
+            writer.write_lexeme(std::get<0>(symbol));
+            writer.write_lexeme(std::get<1>(symbol));
+        }
+
+        writer.write_u32(static_cast<std::uint32_t>(value.name_extensions().size()));
+        for (const auto& extension : value.name_extensions()) {
+            writer.write_lexeme(extension);
+        }
+
+        writer.write_u8(value.has_conversion_defined() ? 1 : 0);
+        if (value.has_conversion_defined()) {
+            writer.write_lexeme(value.conversion_input());
+            writer.write_lexeme(value.conversion_output());
+        }
+
+        writer.write_u8(value.assemble_sprite_sheet() ? 1 : 0);
+
+        writer.write_u32(static_cast<std::uint32_t>(value.joined_value_count()));
+        for (std::size_t i = 0; i < value.joined_value_count(); ++i) {
+            write_field_value(writer, value.joined_value_at(static_cast<int>(i)));
+        }
+    }
+
+    auto read_field_value(module_reader& reader) -> kdl::build_target::type_field_value
+    {
+        kdl::build_target::type_field_value value(reader.read_lexeme());
+
+        if (auto export_name = reader.read_optional_lexeme()) {
+            value.set_export_name(export_name.value());
+        }
+
+        if (reader.read_u8() != 0) {
+            kdl::build_target::kdl_type explicit_type;
+            explicit_type.set_reference(reader.read_u8() != 0);
+            if (auto name = reader.read_optional_lexeme()) {
+                explicit_type.set_name(name.value());
+            }
+
+            std::vector<kdl::lexeme> hints;
+            auto hint_count = reader.read_u32();
+            for (std::uint32_t i = 0; i < hint_count; ++i) {
+                hints.emplace_back(reader.read_lexeme());
+            }
+            explicit_type.set_type_hints(hints);
+            value.set_explicit_type(explicit_type);
+        }
+
+        if (auto default_value = reader.read_optional_lexeme()) {
+            value.set_default_value(default_value.value());
+        }
+
+        std::vector<std::tuple<kdl::lexeme, kdl::lexeme>> symbols;
+        auto symbol_count = reader.read_u32();
+        for (std::uint32_t i = 0; i < symbol_count; ++i) {
+            auto name = reader.read_lexeme();
+            symbols.emplace_back(name, reader.read_lexeme());
+        }
+        value.set_symbols(symbols);
+
+        std::vector<kdl::lexeme> extensions;
+        auto extension_count = reader.read_u32();
+        for (std::uint32_t i = 0; i < extension_count; ++i) {
+            extensions.emplace_back(reader.read_lexeme());
+        }
+        value.set_name_extensions(extensions);
+
+        if (reader.read_u8() != 0) {
+            auto input = reader.read_lexeme();
+            value.set_conversion_map(std::make_tuple(input, reader.read_lexeme()));
+        }
+
+        if (reader.read_u8() != 0) {
+            value.set_assemble_sprite_sheet();
+        }
+
+        auto joined_count = reader.read_u32();
+        for (std::uint32_t i = 0; i < joined_count; ++i) {
+            value.join_value(read_field_value(reader));
+        }
+
+        return value;
+    }
+
+    auto write_field(module_writer& writer, const kdl::build_target::type_field& field) -> void
+    {
+        writer.write_lexeme(field.name());
+        writer.write_u8(field.is_repeatable() ? 1 : 0);
+        writer.write_i32(field.lower_repeat_bound());
+        writer.write_i32(field.upper_repeat_bound());
+        writer.write_lexeme(field.has_repeatable_count_field() ? std::optional(field.repeatable_count_field()) : std::nullopt);
+        writer.write_u8(field.wants_lua_setter() ? 1 : 0);
+
+        writer.write_u32(static_cast<std::uint32_t>(field.expected_values()));
+        for (std::size_t i = 0; i < field.expected_values(); ++i) {
+            write_field_value(writer, field.value_at(static_cast<int>(i)));
+        }
+    }
+
+    auto read_field(module_reader& reader) -> kdl::build_target::type_field
+    {
+        kdl::build_target::type_field field(reader.read_lexeme());
+
+        auto repeatable = reader.read_u8() != 0;
+        auto lower = reader.read_i32();
+        auto upper = reader.read_i32();
+        if (repeatable) {
+            field.make_repeatable(lower, upper);
+        }
+
+        if (auto count_field = reader.read_optional_lexeme()) {
+            field.set_repeatable_count_field(count_field.value());
+        }
+        field.set_lua_setter(reader.read_u8() != 0);
+
+        auto value_count = reader.read_u32();
+        for (std::uint32_t i = 0; i < value_count; ++i) {
+            field.add_value(read_field_value(reader));
+        }
+
+        return field;
+    }
+
+    auto write_type_container(module_writer& writer, const kdl::build_target::type_container& container) -> void
+    {
+        writer.write_string(container.name());
+        writer.write_string(container.code());
+
+        const auto& binary_fields = container.internal_template().fields();
+        writer.write_u32(static_cast<std::uint32_t>(binary_fields.size()));
+        for (const auto& binary_field : binary_fields) {
+            write_binary_field(writer, binary_field);
+        }
+
+        writer.write_u32(static_cast<std::uint32_t>(container.all_fields().size()));
+        for (const auto& field : container.all_fields()) {
+            write_field(writer, field);
+        }
+
+        writer.write_u32(static_cast<std::uint32_t>(container.assertions().size()));
+        for (const auto& assertion : container.assertions()) {
+            writer.write_lexeme(assertion.lhs());
+            writer.write_u8(static_cast<std::uint8_t>(assertion.operation_type()));
+            writer.write_lexeme(assertion.rhs());
+        }
+    }
+
+    auto read_type_container(module_reader& reader) -> kdl::build_target::type_container
+    {
+        auto name = std::string(reader.read_string());
+        auto code = std::string(reader.read_string());
+        kdl::build_target::type_container container(name, code);
+
+        kdl::build_target::type_template tmpl;
+        auto binary_field_count = reader.read_u32();
+        for (std::uint32_t i = 0; i < binary_field_count; ++i) {
+            tmpl.add_binary_field(read_binary_field(reader));
+        }
+        container.set_internal_template(tmpl);
+
+        auto field_count = reader.read_u32();
+        for (std::uint32_t i = 0; i < field_count; ++i) {
+            container.add_field(read_field(reader));
+        }
+
+        std::vector<kdl::assertion> assertions;
+        auto assertion_count = reader.read_u32();
+        for (std::uint32_t i = 0; i < assertion_count; ++i) {
+            auto lhs = reader.read_lexeme();
+            auto operation = static_cast<enum kdl::assertion::operation>(reader.read_u8());
+            assertions.emplace_back(lhs, operation, reader.read_lexeme());
+        }
+        container.add_assertions(assertions);
+
+        return container;
+    }
+}
+
+// MARK: - Type Containers
+
+auto kdl::build_target::type_module::add_type_container(const type_container& container) -> void
+{
+    m_type_containers.emplace_back(container);
+}
+
+auto kdl::build_target::type_module::type_containers() const -> const std::vector<type_container>&
+{
+    return m_type_containers;
+}
+
+// MARK: - Writing
+
+auto kdl::build_target::type_module::encode(module_writer& writer) const -> void
+{
+    writer.write_u32(static_cast<std::uint32_t>(m_type_containers.size()));
+    for (const auto& container : m_type_containers) {
+        write_type_container(writer, container);
+    }
+}
+
+auto kdl::build_target::type_module::write(const std::string& path) const -> void
+{
+    module_writer writer;
+    encode(writer);
+    writer.write(path, format);
+}
+
+// MARK: - Reading
+
+auto kdl::build_target::type_module::decode(module_reader& reader) -> type_module
+{
+    type_module module;
+    auto type_count = reader.read_u32();
+    module.m_type_containers.reserve(type_count);
+    for (std::uint32_t i = 0; i < type_count; ++i) {
+        module.m_type_containers.emplace_back(read_type_container(reader));
+    }
+    return module;
+}
+
+auto kdl::build_target::type_module::read(const std::shared_ptr<kdl::file>& file, const lexeme& reference) -> type_module
+{
+    module_reader reader(file, format, reference);
+    return decode(reader);
+}
+
+auto kdl::build_target::type_module::is_module_path(const std::string& path) -> bool
+{
+    std::string_view suffix(extension);
+    return path.size() > suffix.size() && path.compare(path.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
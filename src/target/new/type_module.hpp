@@ -0,0 +1,87 @@
+// Copyright (c) 2022 Tom Hancocks
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "parser/file.hpp"
+#include "parser/lexeme.hpp"
+#include "target/new/module_encoding.hpp"
+#include "target/new/type_container.hpp"
+
+namespace kdl::build_target
+{
+
+    /**
+     * A type module is a precompiled set of type definitions. It holds each type container exactly as it was
+     * defined, so that importing it does not need to lex or parse the definitions again.
+     *
+     * The module is laid out so that it can be read directly from a memory mapped file. It begins with a fixed
+     * header, containing the format version and a hash of the rest of the file, which are checked before anything
+     * else is read. Every string is stored once in a table that follows the header, and is interned directly from
+     * the mapped file. The type definitions follow the string table, and refer to strings by their index.
+     *
+     * Lexemes read from a module belong to the module file, but keep the line and offset at which they appeared in
+     * their original source.
+     */
+    class type_module
+    {
+    public:
+        static constexpr std::uint32_t format_version = 2;
+        static constexpr const char *extension = ".kdlm";
+        static constexpr module_format format { { 'K', 'D', 'L', 'M' }, format_version, "type module" };
+
+        type_module() = default;
+
+        auto add_type_container(const type_container& container) -> void;
+        [[nodiscard]] auto type_containers() const -> const std::vector<type_container>&;
+
+        /**
+         * Write the module to the specified path, creating any intermediate directories.
+         */
+        auto write(const std::string& path) const -> void;
+
+        /**
+         * Read a module from a file. If the file is not a module, was written with a different format version or
+         * has been damaged, then a fatal error is raised against the reference lexeme.
+         */
+        static auto read(const std::shared_ptr<kdl::file>& file, const lexeme& reference) -> type_module;
+
+        /**
+         * Encode or decode the type definitions of the module, as part of a larger precompiled file such as an
+         * object file.
+         */
+        auto encode(module_writer& writer) const -> void;
+        static auto decode(module_reader& reader) -> type_module;
+
+        /**
+         * Check if the specified path refers to a type module.
+         */
+        static auto is_module_path(const std::string& path) -> bool;
+
+    private:
+        std::vector<type_container> m_type_containers;
+    };
+
+}
@@ -27,7 +27,16 @@
 
 auto kdl::build_target::type_template::add_binary_field(const kdl::build_target::type_template::binary_field& field) -> void
 {
+    // Labels are indexed as fields are added so that look ups never need to scan the template. The first field to
+    // use a label takes precedence, which matches the order in which the template was previously searched.
+    auto index = m_fields.size();
     m_fields.emplace_back(field);
+
+    m_field_indices.emplace(field.label.symbol(), index);
+    m_label_locations.emplace(field.label.symbol(), field_location { index, -1 });
+    for (std::size_t i = 0; i < field.list_fields.size(); ++i) {
+        m_label_locations.emplace(field.list_fields[i].label.symbol(), field_location { index, static_cast<int>(i) });
+    }
 }
 
 // MARK: - Field Look Up
@@ -37,31 +46,31 @@ auto kdl::build_target::type_template::binary_field_count() const -> std::size_t
     return m_fields.size();
 }
 
-auto kdl::build_target::type_template::binary_field_at(const std::size_t& n) const -> kdl::build_target::type_template::binary_field
+auto kdl::build_target::type_template::binary_field_at(const std::size_t& n) const -> const kdl::build_target::type_template::binary_field&
 {
     return m_fields.at(n);
 }
 
-auto kdl::build_target::type_template::binary_field_named(const std::string& name) const -> kdl::build_target::type_template::binary_field
+auto kdl::build_target::type_template::find_label(const kdl::lexeme& lx) const -> const kdl::build_target::type_template::binary_field *
+{
+    auto it = m_label_locations.find(lx.symbol());
+    if (it == m_label_locations.end()) {
+        return nullptr;
+    }
+
+    const auto& field = m_fields[it->second.index];
+    return (it->second.list_index < 0) ? &field : &field.list_fields[it->second.list_index];
+}
+
+auto kdl::build_target::type_template::binary_field_named(const std::string& name) const -> const kdl::build_target::type_template::binary_field&
 {
     return binary_field_named(lexeme(name, lexeme::identifier));
 }
 
-auto kdl::build_target::type_template::binary_field_named(const kdl::lexeme& lx) const -> kdl::build_target::type_template::binary_field
+auto kdl::build_target::type_template::binary_field_named(const kdl::lexeme& lx) const -> const kdl::build_target::type_template::binary_field&
 {
-    auto i = 0;
-    for (const auto& f : m_fields) {
-        if (lx.is(f.label.text())) {
-            return f;
-        }
-        else {
-            for (const auto& lf : f.list_fields) {
-                if (lx.is(lf.label.text())) {
-                    return lf;
-                }
-            }
-        }
-        ++i;
+    if (auto field = find_label(lx)) {
+        return *field;
     }
     log::fatal_error(lx, 1, "Could not find binary field '" + lx.text() + "' inside template.");
 }
@@ -73,12 +82,9 @@ auto kdl::build_target::type_template::binary_field_index(const std::string& nam
 
 auto kdl::build_target::type_template::binary_field_index(const kdl::lexeme& lx) const -> int
 {
-    auto i = 0;
-    for (const auto& f : m_fields) {
-        if (lx.is(f.label.text())) {
-            return i;
-        }
-        ++i;
+    auto it = m_field_indices.find(lx.symbol());
+    if (it != m_field_indices.end()) {
+        return static_cast<int>(it->second);
     }
     log::fatal_error(lx, 1, "Could not find binary field '" + lx.text() + "' inside template.");
 }
@@ -91,21 +97,7 @@ auto kdl::build_target::type_template::fields() const -> const std::vector<binar
 
 auto kdl::build_target::type_template::has_binary_field_named(const lexeme& lx) const -> bool
 {
-    auto i = 0;
-    for (const auto& f : m_fields) {
-        if (lx.is(f.label.text())) {
-            return true;
-        }
-        else {
-            for (const auto& lf : f.list_fields) {
-                if (lx.is(lf.label.text())) {
-                    return true;
-                }
-            }
-        }
-        ++i;
-    }
-    return false;
+    return find_label(lx) != nullptr;
 }
 
 auto kdl::build_target::type_template::has_binary_field_named(const std::string& name) const -> bool
@@ -23,6 +23,7 @@
 #include <vector>
 #include <tuple>
 #include <string>
+#include <unordered_map>
 #include "target/new/binary_type.hpp"
 #include "parser/lexeme.hpp"
 
@@ -59,9 +60,9 @@ namespace kdl::build_target
         auto add_binary_field(const binary_field& field) -> void;
 
         [[nodiscard]] auto binary_field_count() const -> std::size_t;
-        [[nodiscard]] auto binary_field_at(const std::size_t& index) const -> binary_field;
-        [[nodiscard]] auto binary_field_named(const std::string& name) const -> binary_field;
-        [[nodiscard]] auto binary_field_named(const lexeme& lx) const -> binary_field;
+        [[nodiscard]] auto binary_field_at(const std::size_t& index) const -> const binary_field&;
+        [[nodiscard]] auto binary_field_named(const std::string& name) const -> const binary_field&;
+        [[nodiscard]] auto binary_field_named(const lexeme& lx) const -> const binary_field&;
         [[nodiscard]] auto binary_field_index(const std::string& name) const -> int;
         [[nodiscard]] auto binary_field_index(const lexeme& lx) const -> int;
 
@@ -71,7 +72,21 @@ namespace kdl::build_target
         [[nodiscard]] auto fields() const -> const std::vector<binary_field>&;
 
     private:
+        /**
+         * The location of a binary field inside the template. List fields are located by the index of the
+         * list they belong to, and their index inside that list.
+         */
+        struct field_location
+        {
+            std::size_t index;
+            int list_index;
+        };
+
         std::vector<binary_field> m_fields;
+        std::unordered_map<symbol_table::symbol, std::size_t> m_field_indices;
+        std::unordered_map<symbol_table::symbol, field_location> m_label_locations;
+
+        [[nodiscard]] auto find_label(const lexeme& lx) const -> const binary_field *;
 
     };
 
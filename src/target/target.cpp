@@ -18,8 +18,14 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <filesystem>
+#include <mutex>
+#include <thread>
 #include "target/target.hpp"
+#include "target/new/assembly_cache.hpp"
 #include "diagnostic/fatal.hpp"
 #include "parser/file.hpp"
 
@@ -28,15 +34,53 @@
 kdl::target::target()
     : m_dst_root("."),
       m_dst_file("result"),
-      m_resource_tracking_table(std::make_shared<kdl::resource_tracking::table>())
+      m_resource_tracking_table(std::make_shared<kdl::resource_tracking::table>()),
+      m_output(&std::cout)
 {
 
 }
 
+auto kdl::target::fork() const -> std::shared_ptr<target>
+{
+    auto forked = std::make_shared<target>();
+    forked->m_name = m_name;
+    forked->m_version = m_version;
+    forked->m_authors = m_authors;
+    forked->m_dst_root = m_dst_root;
+    forked->m_dst_file = m_dst_file;
+    forked->m_src_root = m_src_root;
+    forked->m_scenario_root = m_scenario_root;
+    forked->m_format = m_format;
+    forked->m_required_format = m_required_format;
+    forked->m_verify_expressions = m_verify_expressions;
+    forked->m_disassembler_image_format = m_disassembler_image_format;
+    forked->m_disassembler_sound_format = m_disassembler_sound_format;
+
+    // Types build their default prototype on first use, and expressions cache their compiled form and results, so
+    // each target needs its own copy of them.
+    for (const auto& container : m_type_containers) {
+        forked->add_type_container(*container);
+    }
+    for (const auto& function : m_functions) {
+        forked->m_functions.emplace(function.first, function.second->copy());
+    }
+
+    forked->m_globals = m_globals;
+    forked->m_mutable_globals = m_mutable_globals;
+    forked->m_global_generation = m_global_generation;
+    forked->m_resource_tracking_table = std::make_shared<kdl::resource_tracking::table>(*m_resource_tracking_table);
+    forked->m_imports = m_imports;
+    forked->m_multiple_imports = m_multiple_imports;
+    forked->m_import_cache = m_import_cache;
+    return forked;
+}
+
 // MARK: - File
 
 auto kdl::target::file() -> graphite::rsrc::file&
 {
+    // Anything reading from the file expects to see every resource that has been declared up to this point.
+    assemble_resources();
     return m_file;
 }
 
@@ -62,7 +106,18 @@ auto kdl::target::set_version_string(const std::string& version) -> void
 
 auto kdl::target::add_type_container(const build_target::type_container& container) -> void
 {
-    m_type_containers.emplace_back(container);
+    add_type_container(build_target::type_container(container));
+}
+
+auto kdl::target::add_type_container(build_target::type_container&& container) -> void
+{
+    // Types are indexed by name. Should a name be defined more than once, lookups continue to resolve to the
+    // earliest definition.
+    container.freeze();
+
+    auto index = m_type_containers.size();
+    m_type_container_names.emplace(container.name(), index);
+    m_type_containers.emplace_back(std::make_shared<const build_target::type_container>(std::move(container)));
 }
 
 auto kdl::target::type_container_count() const -> std::size_t
@@ -70,33 +125,33 @@ auto kdl::target::type_container_count() const -> std::size_t
     return m_type_containers.size();
 }
 
-auto kdl::target::type_container_at(int i) const -> build_target::type_container
+auto kdl::target::type_container_at(int i) const -> const build_target::type_container&
 {
-    return m_type_containers[i];
+    return *m_type_containers[i];
 }
 
-auto kdl::target::type_container_named(const kdl::lexeme& name) const -> build_target::type_container
+auto kdl::target::type_container_named(const kdl::lexeme& name) const -> const build_target::type_container&
 {
-    for (const auto& c : m_type_containers) {
-        // We have found a type container with the specified name.
-        if (c.name() == name.text()) {
-            return c;
-        }
+    if (auto container = find_type_container(name.text())) {
+        return *container;
     }
     log::fatal_error(name, 1, "Missing definition for type '" + name.text() + "'");
 }
 
-auto kdl::target::type_container_named(const std::string& name) const -> build_target::type_container
+auto kdl::target::type_container_named(const std::string& name) const -> const build_target::type_container&
 {
-    for (const auto& c : m_type_containers) {
-        // We have found a type container with the specified name.
-        if (c.name() == name) {
-            return c;
-        }
+    if (auto container = find_type_container(name)) {
+        return *container;
     }
     log::fatal_error({ name, lexeme::identifier }, 1, "Missing definition for type '" + name + "'");
 }
 
+auto kdl::target::find_type_container(const std::string& name) const -> std::shared_ptr<const build_target::type_container>
+{
+    auto it = m_type_container_names.find(name);
+    return (it != m_type_container_names.end()) ? m_type_containers[it->second] : nullptr;
+}
+
 auto kdl::target::has_type_named(const kdl::lexeme &name) const -> bool
 {
     return has_type_named(name.text());
@@ -104,12 +159,7 @@ auto kdl::target::has_type_named(const kdl::lexeme &name) const -> bool
 
 auto kdl::target::has_type_named(const std::string &name) const -> bool
 {
-    for (const auto& c : m_type_containers) {
-        if (c.name() == name) {
-            return true;
-        }
-    }
-    return false;
+    return m_type_container_names.find(name) != m_type_container_names.end();
 }
 
 // MARK: - Destination Paths
@@ -261,16 +311,161 @@ auto kdl::target::is_extended_format() const -> bool
     return m_required_format == graphite::rsrc::file::format::extended;
 }
 
+auto kdl::target::required_format() const -> std::optional<enum graphite::rsrc::file::format>
+{
+    return m_required_format;
+}
+
 // MARK: - Resource Management
 
 auto kdl::target::add_resource(build_target::resource_constructor& resource) -> void
 {
     m_resource_tracking_table->add_instance(m_file.name(), resource.type_code(), resource.id(), resource.name());
-    m_file.add_resource(resource.type_code(),
-                        resource.id(),
-                        resource.name(),
-                        resource.assemble(),
-                        resource.attributes());
+    m_resources.emplace_back(resource);
+    m_resource_import_keys.emplace_back();
+}
+
+auto kdl::target::add_resource(build_target::resource_constructor& resource, const kdl::lexeme& declaration) -> void
+{
+    add_resource(resource);
+    if (auto file = declaration.owner()) {
+        m_resource_import_keys.back() = canonical_import_path(file->path());
+    }
+}
+
+auto kdl::target::resource_import_key(std::size_t index) const -> const std::string&
+{
+    return m_resource_import_keys.at(index);
+}
+
+auto kdl::target::resources() const -> const std::vector<build_target::resource_constructor>&
+{
+    return m_resources;
+}
+
+auto kdl::target::set_assembly_jobs(std::size_t jobs) -> void
+{
+    m_assembly_jobs = std::max<std::size_t>(jobs, 1);
+}
+
+auto kdl::target::assembly_jobs() const -> std::size_t
+{
+    return m_assembly_jobs;
+}
+
+auto kdl::target::assemble_resources() -> void
+{
+    auto first = m_assembled_resources;
+    auto count = m_resources.size() - first;
+    auto jobs = std::min(m_assembly_jobs, count);
+
+    if (jobs <= 1) {
+        for (; m_assembled_resources < m_resources.size(); ++m_assembled_resources) {
+            auto& resource = m_resources[m_assembled_resources];
+            m_file.add_resource(resource.type_code(),
+                                resource.id(),
+                                resource.name(),
+                                assemble_resource(resource),
+                                resource.attributes());
+        }
+        return;
+    }
+
+    // Each resource only touches its own values whilst being assembled, so they can be handed out to the workers
+    // in any order. The results are kept in declaration order so that the output is the same as a serial build.
+    std::vector<std::optional<graphite::data::block>> assembled(count);
+    std::atomic<std::size_t> next { 0 };
+
+    // Should any resource fail, the one declared first is reported once every worker has stopped, as it would have
+    // been in a serial build. Resources are handed out in order, so every earlier resource has already been started.
+    std::mutex error_lock;
+    std::optional<log::fatal_diagnostic> error;
+    auto error_index = count;
+
+    auto worker = [&] {
+        log::deferred_errors deferred;
+        for (auto i = next++; i < count; i = next++) {
+            try {
+                assembled[i] = assemble_resource(m_resources[first + i]);
+            }
+            catch (const log::fatal_diagnostic& diagnostic) {
+                std::lock_guard<std::mutex> lock(error_lock);
+                if (i < error_index) {
+                    error_index = i;
+                    error = diagnostic;
+                }
+                next = count;
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(jobs - 1);
+    for (std::size_t n = 1; n < jobs; ++n) {
+        workers.emplace_back(worker);
+    }
+    worker();
+
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    if (error.has_value()) {
+        log::fatal_error(error.value());
+    }
+
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto& resource = m_resources[first + i];
+        m_file.add_resource(resource.type_code(),
+                            resource.id(),
+                            resource.name(),
+                            std::move(assembled[i].value()),
+                            resource.attributes());
+    }
+    m_assembled_resources = m_resources.size();
+}
+
+auto kdl::target::assemble_resource(build_target::resource_constructor& resource) -> graphite::data::block
+{
+    auto key = m_assembly_cache ? resource.cache_key() : std::nullopt;
+    if (!key.has_value()) {
+        return resource.assemble();
+    }
+
+    if (auto cached = m_assembly_cache->lookup(key.value())) {
+        return std::move(cached.value());
+    }
+
+    auto data = resource.assemble();
+    m_assembly_cache->store(key.value(), data);
+    return data;
+}
+
+auto kdl::target::set_assembly_cache(std::shared_ptr<build_target::assembly_cache> cache) -> void
+{
+    m_assembly_cache = std::move(cache);
+}
+
+auto kdl::target::assembly_cache() const -> std::shared_ptr<build_target::assembly_cache>
+{
+    return m_assembly_cache;
+}
+
+auto kdl::target::write_ir(std::ostream& stream) const -> void
+{
+    for (const auto& resource : m_resources) {
+        resource.write_ir(stream);
+    }
+}
+
+auto kdl::target::set_output(std::ostream& stream) -> void
+{
+    m_output = &stream;
+}
+
+auto kdl::target::output() const -> std::ostream&
+{
+    return *m_output;
 }
 
 // MARK: - Saving
@@ -302,6 +497,7 @@ auto kdl::target::target_file_path() const -> std::string
 auto kdl::target::save() -> void
 {
 //    std::cout << "saving to " << target_file_path() << std::endl;
+    assemble_resources();
     m_file.write(target_file_path(), m_format);
 }
 
@@ -336,39 +532,183 @@ auto kdl::target::resource_tracker() const -> std::shared_ptr<kdl::resource_trac
     return m_resource_tracking_table;
 }
 
+auto kdl::target::set_id_allocation_policy(resource_tracking::table::allocation_policy policy) -> void
+{
+    resource_tracking::allocation_event event;
+    event.type = resource_tracking::allocation_event::event_type::policy;
+    event.policy = policy;
+    apply_id_allocation_event(event);
+}
+
+auto kdl::target::reserve_resource_ids(const std::string& type_code, int64_t first, int64_t last) -> void
+{
+    resource_tracking::allocation_event event;
+    event.type = resource_tracking::allocation_event::event_type::reservation;
+    event.type_code = type_code;
+    event.first = first;
+    event.last = last;
+    apply_id_allocation_event(event);
+}
+
+auto kdl::target::apply_id_allocation_event(const resource_tracking::allocation_event& event) -> void
+{
+    switch (event.type) {
+        case resource_tracking::allocation_event::event_type::policy: {
+            m_resource_tracking_table->set_allocation_policy(event.policy);
+            break;
+        }
+        case resource_tracking::allocation_event::event_type::reservation: {
+            m_resource_tracking_table->reserve_ids(event.type_code, event.first, event.last);
+            break;
+        }
+    }
+
+    auto recorded = event;
+    recorded.resource_index = m_resources.size();
+    m_id_allocation_events.emplace_back(std::move(recorded));
+}
+
+auto kdl::target::id_allocation_events() const -> const std::vector<resource_tracking::allocation_event>&
+{
+    return m_id_allocation_events;
+}
+
 // MARK: - Imported File Tracker
 
 auto kdl::target::track_imported_file(std::weak_ptr<kdl::file> file) -> void
 {
     if (auto strong = file.lock()) {
+        m_imports.emplace(canonical_import_path(strong->path()));
         m_imported_files.emplace_back(strong);
     }
 }
 
+auto kdl::target::canonical_import_path(const std::string& path) -> std::string
+{
+    std::error_code err;
+    auto canonical = std::filesystem::weakly_canonical(std::filesystem::path(path), err);
+    return err ? path : canonical.string();
+}
+
+auto kdl::target::should_import(const std::string& key) -> bool
+{
+    // Imports are only performed once, unless the imported source has explicitly opted in to being imported
+    // multiple times.
+    if (m_imports.emplace(key).second) {
+        return true;
+    }
+    return m_multiple_imports.find(key) != m_multiple_imports.end();
+}
+
+auto kdl::target::imports() const -> std::vector<std::string>
+{
+    std::vector<std::string> imports;
+    for (const auto& key : m_imports) {
+        if (m_multiple_imports.find(key) == m_multiple_imports.end()) {
+            imports.emplace_back(key);
+        }
+    }
+    std::sort(imports.begin(), imports.end());
+    return imports;
+}
+
+auto kdl::target::allow_multiple_imports(const std::string& key) -> void
+{
+    m_multiple_imports.emplace(key);
+
+    // The file is still being parsed, so its lexemes are still alive and can now be kept for the next import.
+    auto it = m_import_lexemes.find(key);
+    if (it != m_import_lexemes.end()) {
+        if (auto lexemes = it->second.lock()) {
+            m_import_cache[key] = std::move(lexemes);
+        }
+        m_import_lexemes.erase(it);
+    }
+}
+
+auto kdl::target::cached_import(const std::string& key) const -> std::shared_ptr<const std::vector<lexeme>>
+{
+    auto it = m_import_cache.find(key);
+    return (it != m_import_cache.end()) ? it->second : nullptr;
+}
+
+auto kdl::target::cache_import(const std::string& key, std::shared_ptr<const std::vector<lexeme>> lexemes) -> void
+{
+    if (m_multiple_imports.find(key) != m_multiple_imports.end()) {
+        m_import_cache[key] = std::move(lexemes);
+    }
+    else {
+        // Whether the file may be imported again is not known until its pragmas have been parsed, so only a weak
+        // reference is held until then. The parser owns the lexemes for as long as it is reading them, and once
+        // it has finished with them the entry is of no further use.
+        std::erase_if(m_import_lexemes, [] (const auto& it) { return it.second.expired(); });
+        m_import_lexemes[key] = lexemes;
+    }
+}
+
 // MARK: - Global Variables
 
 auto kdl::target::set_global_variable(const std::string& var_name, const kdl::lexeme &value) -> void
+{
+    set_global_variable(symbol_table::shared().intern(var_name), build_target::kdl_value::of(value));
+}
+
+auto kdl::target::set_global_variable(symbol_table::symbol var_name, const build_target::kdl_value& value) -> void
 {
     auto it = m_globals.find(var_name);
     if (it != m_globals.end()) {
+        // Any variable that is assigned more than once is mutable, regardless of how it was declared.
+        if (m_mutable_globals.insert(var_name).second) {
+            m_global_generation++;
+        }
         it->second = value;
         return;
     }
     m_globals.insert(std::pair(var_name, value));
+    m_global_generation++;
 }
 
-auto kdl::target::global_variable(const std::string& var_name) const -> std::optional<kdl::lexeme>
+auto kdl::target::set_global_variable_mutable(const std::string& var_name) -> void
+{
+    if (m_mutable_globals.insert(symbol_table::shared().intern(var_name)).second) {
+        m_global_generation++;
+    }
+}
+
+auto kdl::target::is_global_variable_mutable(symbol_table::symbol var_name) const -> bool
+{
+    return m_mutable_globals.find(var_name) != m_mutable_globals.end();
+}
+
+auto kdl::target::global_generation() const -> std::uint64_t
+{
+    return m_global_generation;
+}
+
+auto kdl::target::global_value(symbol_table::symbol var_name) const -> const build_target::kdl_value *
 {
     auto it = m_globals.find(var_name);
     if (it != m_globals.end()) {
-        return it->second;
+        return &it->second;
+    }
+    return nullptr;
+}
+
+auto kdl::target::global_variable(const std::string& var_name) const -> std::optional<kdl::lexeme>
+{
+    if (auto value = global_value(symbol_table::shared().intern(var_name))) {
+        return value->to_lexeme();
     }
     return {};
 }
 
 auto kdl::target::all_global_variables() const -> std::unordered_map<std::string, kdl::lexeme>
 {
-    return m_globals;
+    std::unordered_map<std::string, kdl::lexeme> globals;
+    for (const auto& it : m_globals) {
+        globals.insert(std::pair(symbol_table::shared()[it.first].text, it.second.to_lexeme()));
+    }
+    return globals;
 }
 
 // MARK: - Functions
@@ -376,14 +716,39 @@ auto kdl::target::all_global_variables() const -> std::unordered_map<std::string
 auto kdl::target::set_function_expression(const std::string &name, std::shared_ptr<build_target::kdl_expression> expression) -> void
 {
     m_functions.insert(std::pair(name, expression));
+    m_global_generation++;
 }
 
 auto kdl::target::function_expression(const std::string &name) const -> std::shared_ptr<build_target::kdl_expression>
 {
-    for (const auto& expr : m_functions) {
-        if (expr.first == name) {
-            return expr.second;
-        }
+    auto it = m_functions.find(name);
+    if (it != m_functions.end()) {
+        return it->second;
     }
     return nullptr;
+}
+
+auto kdl::target::all_function_expressions() const -> const std::unordered_map<std::string, std::shared_ptr<build_target::kdl_expression>>&
+{
+    return m_functions;
+}
+
+auto kdl::target::set_verify_expressions(bool verify) -> void
+{
+    m_verify_expressions = verify;
+}
+
+auto kdl::target::verifies_expressions() const -> bool
+{
+    return m_verify_expressions;
+}
+
+auto kdl::target::expression_statistics() -> build_target::expression_statistics&
+{
+    return m_expression_statistics;
+}
+
+auto kdl::target::expression_statistics() const -> const build_target::expression_statistics&
+{
+    return m_expression_statistics;
 }
\ No newline at end of file
@@ -20,11 +20,14 @@
 
 #pragma once
 
+#include <ostream>
 #include <string>
 #include <vector>
 #include <optional>
 #include <memory>
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
 #include "disassembler/task.hpp"
 #include "target/new/kdl_expression.hpp"
 #include "target/new/type_container.hpp"
@@ -33,6 +36,11 @@
 #include "target/track/resource_tracking.hpp"
 #include "parser/file.hpp"
 
+namespace kdl::build_target
+{
+    class assembly_cache;
+}
+
 namespace kdl
 {
 
@@ -46,6 +54,14 @@ namespace kdl
     public:
         target();
 
+        /**
+         * Create a new target that starts from everything that has been defined in this target so far: its types,
+         * global variables, functions, imports and tracked resource ids. None of the declared resources are
+         * included. The new target shares no mutable state with this one, so that it can be parsed into on another
+         * thread.
+         */
+        [[nodiscard]] auto fork() const -> std::shared_ptr<target>;
+
         [[nodiscard]] auto file() -> graphite::rsrc::file&;
 
         auto set_project_name(const std::string& name) -> void;
@@ -60,26 +76,94 @@ namespace kdl
         auto set_format(const std::string& format) -> void;
         auto set_required_format(const enum graphite::rsrc::file::format& format) -> bool;
         [[nodiscard]] auto is_extended_format() const -> bool;
+        [[nodiscard]] auto required_format() const -> std::optional<enum graphite::rsrc::file::format>;
 
         auto set_src_root(const std::string& src_root) -> void;
         auto resolve_src_path(const kdl::lexeme& path) const -> std::string;
         auto resolve_src_path(const std::string& path, const std::string& source_path = "") const -> std::string;
 
         auto add_type_container(const build_target::type_container& container) -> void;
+        auto add_type_container(build_target::type_container&& container) -> void;
         auto type_container_count() const -> std::size_t;
-        auto type_container_at(int i) const -> build_target::type_container;
-        auto type_container_named(const kdl::lexeme& name) const -> build_target::type_container;
-        auto type_container_named(const std::string& name) const -> build_target::type_container;
+        auto type_container_at(int i) const -> const build_target::type_container&;
+        auto type_container_named(const kdl::lexeme& name) const -> const build_target::type_container&;
+        auto type_container_named(const std::string& name) const -> const build_target::type_container&;
+        [[nodiscard]] auto find_type_container(const std::string& name) const -> std::shared_ptr<const build_target::type_container>;
         [[nodiscard]] auto has_type_named(const kdl::lexeme& name) const -> bool;
         [[nodiscard]] auto has_type_named(const std::string& name) const -> bool;
         auto add_resource(build_target::resource_constructor& resource) -> void;
 
+        /**
+         * Add a resource that was declared in source. The file containing the declaration is recorded, so that the
+         * resources of a file are only linked from the first object that imported it.
+         */
+        auto add_resource(build_target::resource_constructor& resource, const kdl::lexeme& declaration) -> void;
+        [[nodiscard]] auto resource_import_key(std::size_t index) const -> const std::string&;
+
+        /**
+         * The resources that have been declared so far, in declaration order. These are held as their resolved
+         * field values and are not assembled into binary data until the assembly stage is run.
+         */
+        [[nodiscard]] auto resources() const -> const std::vector<build_target::resource_constructor>&;
+
+        /**
+         * Run the assembly stage on any resources that have been declared since it was last run, adding the
+         * assembled data to the output file.
+         *
+         * When more than one assembly job is allowed, the resources are assembled concurrently but are always added
+         * to the output file in the order that they were declared.
+         */
+        auto assemble_resources() -> void;
+
+        auto set_assembly_jobs(std::size_t jobs) -> void;
+        [[nodiscard]] auto assembly_jobs() const -> std::size_t;
+
+        /**
+         * Reuse the assembled data of resources from previous builds, where the resource has not changed. Only
+         * resources that are expensive to assemble, such as those containing converted media, are cached.
+         */
+        auto set_assembly_cache(std::shared_ptr<build_target::assembly_cache> cache) -> void;
+        [[nodiscard]] auto assembly_cache() const -> std::shared_ptr<build_target::assembly_cache>;
+
+        /**
+         * Write a textual representation of the declared resources, prior to them being assembled.
+         */
+        auto write_ir(std::ostream& stream) const -> void;
+
+        /**
+         * The stream that messages from the source, such as those of @out directives, are written to. This is the
+         * standard output unless another stream has been set.
+         */
+        auto set_output(std::ostream& stream) -> void;
+        [[nodiscard]] auto output() const -> std::ostream&;
+
         auto set_global_variable(const std::string& var_name, const kdl::lexeme& value) -> void;
+        auto set_global_variable(symbol_table::symbol var_name, const build_target::kdl_value& value) -> void;
+        auto set_global_variable_mutable(const std::string& var_name) -> void;
+        [[nodiscard]] auto is_global_variable_mutable(symbol_table::symbol var_name) const -> bool;
         [[nodiscard]] auto all_global_variables() const -> std::unordered_map<std::string, kdl::lexeme>;
         [[nodiscard]] auto global_variable(const std::string& var_name) const -> std::optional<kdl::lexeme>;
 
+        /**
+         * Look up the typed value of a global variable by its interned name. Numeric values are held decoded, and
+         * are only formatted as text if they are requested as a lexeme.
+         */
+        [[nodiscard]] auto global_value(symbol_table::symbol var_name) const -> const build_target::kdl_value *;
+
         auto set_function_expression(const std::string& name, std::shared_ptr<struct build_target::kdl_expression> expression) -> void;
         [[nodiscard]] auto function_expression(const std::string& name) const -> std::shared_ptr<struct build_target::kdl_expression>;
+        [[nodiscard]] auto all_function_expressions() const -> const std::unordered_map<std::string, std::shared_ptr<struct build_target::kdl_expression>>&;
+
+        /**
+         * A counter that changes whenever a global variable or function is defined, or a global variable becomes
+         * mutable. Anything derived from the purity of an expression is only valid whilst this remains unchanged.
+         */
+        [[nodiscard]] auto global_generation() const -> std::uint64_t;
+
+        auto set_verify_expressions(bool verify) -> void;
+        [[nodiscard]] auto verifies_expressions() const -> bool;
+        auto expression_statistics() -> build_target::expression_statistics&;
+        [[nodiscard]] auto expression_statistics() const -> const build_target::expression_statistics&;
 
         auto set_disassembler_image_format(const std::vector<lexeme>& formats) -> void;
         auto set_disassembler_sound_format(const std::vector<lexeme>& formats) -> void;
@@ -87,9 +171,35 @@ namespace kdl
         auto disassembler() const -> std::optional<disassembler::task>;
 
         auto track_imported_file(std::weak_ptr<kdl::file> file) -> void;
+        [[nodiscard]] static auto canonical_import_path(const std::string& path) -> std::string;
+        auto should_import(const std::string& key) -> bool;
+        auto allow_multiple_imports(const std::string& key) -> void;
+
+        /**
+         * The keys of the files and libraries that have been imported, or given as input, and that will not be
+         * imported again.
+         */
+        [[nodiscard]] auto imports() const -> std::vector<std::string>;
+        [[nodiscard]] auto cached_import(const std::string& key) const -> std::shared_ptr<const std::vector<lexeme>>;
+
+        /**
+         * Offer the lexemes of an imported file to the import cache. They are only kept beyond the parse of the file
+         * if it allows itself to be imported multiple times, as no other file is ever imported again.
+         */
+        auto cache_import(const std::string& key, std::shared_ptr<const std::vector<lexeme>> lexemes) -> void;
 
         auto resource_tracker() const -> std::shared_ptr<kdl::resource_tracking::table>;
 
+        /**
+         * Change the policy used to allocate ids to resources declared with #auto, or reserve a range of ids so
+         * that they are never automatically allocated. Each change is recorded along with the number of resources
+         * declared before it, so that an object file can make it at the same point when it is linked.
+         */
+        auto set_id_allocation_policy(resource_tracking::table::allocation_policy policy) -> void;
+        auto reserve_resource_ids(const std::string& type_code, int64_t first, int64_t last) -> void;
+        auto apply_id_allocation_event(const resource_tracking::allocation_event& event) -> void;
+        [[nodiscard]] auto id_allocation_events() const -> const std::vector<resource_tracking::allocation_event>&;
+
         auto save() -> void;
 
     private:
@@ -102,19 +212,36 @@ namespace kdl
         std::string m_scenario_root;
         enum graphite::rsrc::file::format m_format { graphite::rsrc::file::format::classic };
         std::optional<enum graphite::rsrc::file::format> m_required_format {};
-        std::vector<build_target::type_container> m_type_containers;
+        std::vector<std::shared_ptr<const build_target::type_container>> m_type_containers;
+        std::unordered_map<std::string, std::size_t> m_type_container_names;
         std::vector<build_target::type_container> m_attributed_type_containers;
         graphite::rsrc::file m_file;
+        std::vector<build_target::resource_constructor> m_resources;
+        std::vector<std::string> m_resource_import_keys;
+        std::vector<resource_tracking::allocation_event> m_id_allocation_events;
+        std::size_t m_assembled_resources { 0 };
+        std::size_t m_assembly_jobs { 1 };
+        std::shared_ptr<build_target::assembly_cache> m_assembly_cache;
         std::shared_ptr<kdl::resource_tracking::table> m_resource_tracking_table {};
-        std::unordered_map<std::string, kdl::lexeme> m_globals;
+        std::unordered_map<symbol_table::symbol, build_target::kdl_value> m_globals;
         std::unordered_map<std::string, std::shared_ptr<build_target::kdl_expression>> m_functions;
+        std::unordered_set<symbol_table::symbol> m_mutable_globals;
+        std::uint64_t m_global_generation { 0 };
+        bool m_verify_expressions { false };
+        build_target::expression_statistics m_expression_statistics;
         std::vector<std::shared_ptr<kdl::file>> m_imported_files;
+        std::unordered_set<std::string> m_imports;
+        std::unordered_set<std::string> m_multiple_imports;
+        std::unordered_map<std::string, std::shared_ptr<const std::vector<lexeme>>> m_import_cache;
+        std::unordered_map<std::string, std::weak_ptr<const std::vector<lexeme>>> m_import_lexemes;
+        std::ostream *m_output;
 
         std::optional<disassembler::task> m_disassembler;
         std::vector<lexeme> m_disassembler_image_format { lexeme("PNG", lexeme::identifier) };
         std::vector<lexeme> m_disassembler_sound_format { lexeme("WAV", lexeme::identifier) };
 
         auto target_file_path() const -> std::string;
+        auto assemble_resource(build_target::resource_constructor& resource) -> graphite::data::block;
 
     };
 
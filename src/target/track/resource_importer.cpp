@@ -44,11 +44,11 @@ auto kdl::resource_tracking::importer::populate(kdl::build_target::resource_cons
 
     if (res) {
         // We need the type template of the resource in order to parse out the binary data into the instance.
-        auto tmpl = instance.type_template();
+        const auto& tmpl = instance.type_template();
         graphite::data::reader reader(&res->data());
 
         for (auto i = 0; i < tmpl.binary_field_count(); ++i) {
-            auto field = tmpl.binary_field_at(i);
+            const auto& field = tmpl.binary_field_at(i);
 
             // The data type of the field will tell us how to read the next segment of data from the binary
             // resource data.
@@ -20,6 +20,7 @@
 
 #include <iostream>
 #include <algorithm>
+#include <iterator>
 #include "target/track/resource_tracking.hpp"
 
 // MARK: - Instance Construction
@@ -31,6 +32,51 @@ kdl::resource_tracking::table::instance::instance(const std::string& file, const
 }
 
 
+// MARK: - ID Ranges
+
+auto kdl::resource_tracking::table::id_ranges::insert(int64_t first, int64_t last) -> void
+{
+    // Absorb any ranges that overlap or are adjacent to the new range, including one that starts before it.
+    auto it = m_ranges.upper_bound(first);
+    if (it != m_ranges.begin()) {
+        auto prev = std::prev(it);
+        if (prev->second >= first - 1) {
+            first = prev->first;
+            last = std::max(last, prev->second);
+            it = prev;
+        }
+    }
+
+    while (it != m_ranges.end() && it->first <= last + 1) {
+        last = std::max(last, it->second);
+        it = m_ranges.erase(it);
+    }
+
+    m_ranges[first] = last;
+}
+
+auto kdl::resource_tracking::table::id_ranges::range_end(int64_t id) const -> std::optional<int64_t>
+{
+    auto it = m_ranges.upper_bound(id);
+    if (it == m_ranges.begin()) {
+        return {};
+    }
+
+    --it;
+    if (id > it->second) {
+        return {};
+    }
+    return it->second;
+}
+
+auto kdl::resource_tracking::table::id_ranges::highest() const -> std::optional<int64_t>
+{
+    if (m_ranges.empty()) {
+        return {};
+    }
+    return m_ranges.rbegin()->second;
+}
+
 // MARK: - Instance Management
 
 auto kdl::resource_tracking::table::add_instance(const std::string &file,
@@ -39,30 +85,60 @@ auto kdl::resource_tracking::table::add_instance(const std::string &file,
                                                  const std::string &name) -> void
 {
     m_instances.emplace_back(instance(file, type, id, name));
+    m_ids[type].used.insert(id, id);
 }
 
-auto kdl::resource_tracking::table::instance_exists(const std::string &type, int64_t id) -> bool
+auto kdl::resource_tracking::table::instance_exists(const std::string &type, int64_t id) const -> bool
 {
-    return std::any_of(m_instances.begin(), m_instances.end(), [type, id] (const instance& i) {
-        return (i.type_code == type) && (i.id == id);
-    });
+    auto it = m_ids.find(type);
+    return (it != m_ids.end()) && it->second.used.range_end(id).has_value();
 }
 
 // MARK: - Automatic Resource ID Allocation
 
+auto kdl::resource_tracking::table::set_allocation_policy(allocation_policy policy) -> void
+{
+    m_policy = policy;
+}
+
+auto kdl::resource_tracking::table::policy() const -> allocation_policy
+{
+    return m_policy;
+}
+
+auto kdl::resource_tracking::table::reserve_ids(const std::string &type, int64_t first, int64_t last) -> void
+{
+    m_ids[type].reserved.insert(std::min(first, last), std::max(first, last));
+}
+
 auto kdl::resource_tracking::table::next_available_id(const std::string &type) const -> int64_t
 {
-    // This is going to take a naive approach. We will scan through for the largest ID in the specified type, and then
-    // increment the value by one and return that as the suggestion.
-    // TODO: Potentially change the behaviour of this to find and utilise gaps in the ID space?
     int64_t candidate_id = 128;
 
-    for (const auto& instance : m_instances) {
-        if (instance.type_code != type) {
-            continue;
+    auto it = m_ids.find(type);
+    if (it == m_ids.end()) {
+        return candidate_id;
+    }
+    const auto& ids = it->second;
+
+    // By default the suggestion follows the largest ID in the specified type. When filling gaps, we instead start
+    // from the lowest ID and take the first one that is free.
+    if (m_policy == allocation_policy::highest) {
+        if (auto highest = ids.used.highest()) {
+            candidate_id = std::max(*highest + 1, candidate_id);
         }
-        candidate_id = std::max(instance.id + 1, candidate_id);
     }
 
-    return candidate_id;
+    // Step over any IDs that are in use or reserved. Ranges are merged, so each step skips an entire range.
+    while (true) {
+        if (auto end = ids.used.range_end(candidate_id)) {
+            candidate_id = *end + 1;
+        }
+        else if (auto end = ids.reserved.range_end(candidate_id)) {
+            candidate_id = *end + 1;
+        }
+        else {
+            return candidate_id;
+        }
+    }
 }
@@ -20,20 +20,43 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <map>
+#include <optional>
+#include <unordered_map>
 
 namespace kdl::resource_tracking
 {
 
     class table
     {
+    public:
+        /**
+         * The policy used to allocate an id to resources declared with #auto.
+         */
+        enum class allocation_policy
+        {
+            highest,    // Allocate the id immediately after the highest id in use.
+            fill_gaps   // Allocate the lowest id that is not in use.
+        };
+
     public:
         table() = default;
 
         auto add_instance(const std::string& file, const std::string& type,  int64_t id, const std::string& name) -> void;
-        [[nodiscard]] auto instance_exists(const std::string& type, int64_t id) -> bool;
+        [[nodiscard]] auto instance_exists(const std::string& type, int64_t id) const -> bool;
+
+        auto set_allocation_policy(allocation_policy policy) -> void;
+        [[nodiscard]] auto policy() const -> allocation_policy;
+
+        /**
+         * Reserve a range of ids for the specified type. Reserved ids will never be automatically allocated,
+         * but may still be used explicitly, such as by a component.
+         */
+        auto reserve_ids(const std::string& type, int64_t first, int64_t last) -> void;
 
         [[nodiscard]] auto next_available_id(const std::string& type) const -> int64_t;
 
@@ -50,8 +73,50 @@ namespace kdl::resource_tracking
             instance(const std::string& file, const std::string& type, int64_t id, const std::string& name);
         };
 
+        /**
+         * A set of ids, stored as a map of disjoint ranges. Overlapping and adjacent ranges are merged when they
+         * are inserted, so each range is keyed by its first id and maps to its last id.
+         */
+        class id_ranges
+        {
+        public:
+            auto insert(int64_t first, int64_t last) -> void;
+            [[nodiscard]] auto range_end(int64_t id) const -> std::optional<int64_t>;
+            [[nodiscard]] auto highest() const -> std::optional<int64_t>;
+
+        private:
+            std::map<int64_t, int64_t> m_ranges;
+        };
+
+        struct type_ids
+        {
+            id_ranges used;
+            id_ranges reserved;
+        };
+
         std::vector<instance> m_instances {};
+        std::unordered_map<std::string, type_ids> m_ids {};
+        allocation_policy m_policy { allocation_policy::highest };
+
+    };
+
+    /**
+     * A change to how ids are automatically allocated, made part way through a build. Each change is positioned by
+     * the number of resources that had been declared when it was made, as it only affects those declared after it.
+     */
+    struct allocation_event
+    {
+        enum class event_type : std::uint8_t
+        {
+            policy, reservation
+        };
 
+        std::size_t resource_index { 0 };
+        event_type type { event_type::policy };
+        table::allocation_policy policy { table::allocation_policy::highest };
+        std::string type_code {};
+        int64_t first { 0 };
+        int64_t last { 0 };
     };
 
 }